@@ -0,0 +1,506 @@
+/**
+ * @file
+ * @brief Block file writer, index and mmap reader (see block_file.h)
+ *
+ * Build: gcc -O2 -pthread blockchain_demo.c blockchain.c block_file.c sha256.c -o blockchain_demo
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "block_file.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "block_file maps columns in place and assumes a little-endian host"
+#endif
+
+#define RECORD_PREFIX 8
+#define RECORD_FIXED (BLOCK_HEADER_SIZE + 8)
+#define LOAD_BATCH 256
+
+static uint32_t load_u32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t load_u64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Decode the record at offset without copying its columns
+ * @param next Receives the offset of the following record
+ * @return 1 if a complete, well-formed record is there, 0 otherwise
+ */
+static int parse_record(const uint8_t* data, size_t size, uint64_t offset, BlockView* view, uint64_t* next) {
+    if (offset % 8 != 0 || offset > size || size - offset < RECORD_PREFIX) {
+        return 0;
+    }
+    const uint8_t* p = data + offset;
+    uint64_t length = load_u32(p + 4);
+    if (load_u32(p) != BLOCK_FILE_MAGIC || length % 8 != 0 || length > size - offset - RECORD_PREFIX ||
+        length < RECORD_FIXED + 8) {
+        return 0;
+    }
+    const uint8_t* payload = p + RECORD_PREFIX;
+    uint64_t rows = load_u32(payload + BLOCK_HEADER_SIZE);
+    uint64_t columns = rows * TRANSACTION_ROW_SIZE;
+    if (columns > length - RECORD_FIXED - 8) {
+        return 0;
+    }
+
+    const uint8_t* header = payload;
+    view->header = header;
+    view->index = (int)load_u32(header);
+    view->previous_hash = header + 4;
+    view->merkle_root = header + 4 + HASH_LENGTH;
+    view->timestamp = (time_t)(int64_t)load_u64(header + 4 + 2 * HASH_LENGTH);
+    view->difficulty = load_u32(header + 12 + 2 * HASH_LENGTH);
+    view->nonce = load_u64(header + 16 + 2 * HASH_LENGTH);
+    view->transaction_count = (uint32_t)rows;
+    view->amounts = (const int64_t*)(payload + RECORD_FIXED);
+    view->senders = (const uint32_t*)(view->amounts + rows);
+    view->receivers = view->senders + rows;
+    view->time_deltas = (const int32_t*)(view->receivers + rows);
+
+    const uint8_t* accounts = payload + RECORD_FIXED + columns;
+    const uint8_t* end = payload + length;
+    view->first_account = load_u32(accounts);
+    view->account_count = load_u32(accounts + 4);
+    view->account_names = accounts + 8;
+    const uint8_t* name = view->account_names;
+    for (uint32_t k = 0; k < view->account_count; k++) {
+        if (end - name < 2) {
+            return 0;
+        }
+        size_t len = (size_t)name[0] | (size_t)name[1] << 8;
+        if ((size_t)(end - name - 2) < len) {
+            return 0;
+        }
+        name += 2 + len;
+    }
+    *next = offset + RECORD_PREFIX + length;
+    return 1;
+}
+
+/**
+ * @brief Walk the valid prefix of a data file
+ * @param end Receives the offset just past the last valid record
+ * @param blocks Receives the number of valid records
+ * @param accounts Receives the number of account names they carry
+ */
+static void scan_records(const uint8_t* data, size_t size, uint64_t* end, uint64_t* blocks, uint32_t* accounts) {
+    BlockView view;
+    uint64_t offset = 0;
+    uint64_t next;
+    *blocks = 0;
+    *accounts = 0;
+    while (parse_record(data, size, offset, &view, &next)) {
+        if (view.account_count > 0) {
+            *accounts = view.first_account + view.account_count;
+        }
+        (*blocks)++;
+        offset = next;
+    }
+    *end = offset;
+}
+
+/**
+ * @brief Open (or create) a block file for appending
+ *
+ * A record left incomplete by a crash is cut off, then the index is
+ * truncated or extended so it lists exactly the surviving records.
+ *
+ * @param writer Writer to initialize
+ * @param data_path Block data file
+ * @param index_path Offset index file
+ * @return 1 on success, 0 on I/O error
+ */
+int block_file_writer_open(BlockFileWriter* writer, const char* data_path, const char* index_path) {
+    memset(writer, 0, sizeof(*writer));
+    int data_fd = open(data_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (data_fd < 0) {
+        return 0;
+    }
+    int index_fd = open(index_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (index_fd < 0) {
+        close(data_fd);
+        return 0;
+    }
+
+    struct stat st;
+    uint64_t end = 0;
+    uint64_t indexed = 0;
+    const uint8_t* map = NULL;
+    size_t map_size = 0;
+    int ok = fstat(data_fd, &st) == 0;
+    if (ok && st.st_size > 0) {
+        map_size = (size_t)st.st_size;
+        map = (const uint8_t*)mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, data_fd, 0);
+        ok = map != MAP_FAILED;
+        if (ok) {
+            scan_records(map, map_size, &end, &writer->blocks, &writer->accounts_written);
+        }
+    }
+    ok = ok && ftruncate(data_fd, (off_t)end) == 0 && fstat(index_fd, &st) == 0;
+    if (ok) {
+        indexed = (uint64_t)st.st_size / 8;
+        if (indexed > writer->blocks) {
+            indexed = writer->blocks;
+        }
+        ok = ftruncate(index_fd, (off_t)(indexed * 8)) == 0;
+    }
+    // Records written after the last index flush get their offsets back
+    BlockView view;
+    uint64_t offset = 0;
+    uint64_t next;
+    for (uint64_t i = 0; ok && i < writer->blocks; i++) {
+        parse_record(map, (size_t)end, offset, &view, &next);
+        if (i >= indexed) {
+            ok = write(index_fd, &offset, sizeof(offset)) == (ssize_t)sizeof(offset);
+        }
+        offset = next;
+    }
+    if (map != NULL && map != MAP_FAILED) {
+        munmap((void*)map, map_size);
+    }
+
+    writer->data = ok ? fdopen(data_fd, "a") : NULL;
+    writer->index = writer->data != NULL ? fdopen(index_fd, "a") : NULL;
+    if (writer->index == NULL) {
+        if (writer->data != NULL) {
+            fclose(writer->data);
+        } else {
+            close(data_fd);
+        }
+        close(index_fd);
+        memset(writer, 0, sizeof(*writer));
+        return 0;
+    }
+    setvbuf(writer->data, NULL, _IOFBF, BLOCK_FILE_BUFFER);
+    writer->offset = end;
+    return 1;
+}
+
+/**
+ * @brief Serialize a block as one record
+ * @param chain Chain owning the block, for account names
+ * @param block Block to encode
+ * @param first_account First account ID whose name the record should carry
+ * @param out Destination (8-byte aligned), or NULL to only size the record
+ * @param capacity Bytes available at out
+ * @return Record size (nothing is written if it exceeds capacity), or 0 if an
+ *         account name is over 65535 bytes
+ */
+size_t block_record_encode(const Blockchain* chain, const Block* block, uint32_t first_account, uint8_t* out,
+                           size_t capacity) {
+    size_t rows = (size_t)block->transaction_count;
+    size_t names = 0;
+    for (uint32_t id = first_account; id < chain->accounts.count; id++) {
+        size_t len = strlen(chain->accounts.names[id]);
+        if (len > UINT16_MAX) {
+            return 0;
+        }
+        names += 2 + len;
+    }
+    size_t unpadded = RECORD_FIXED + rows * TRANSACTION_ROW_SIZE + 8 + names;
+    size_t length = (unpadded + 7) & ~(size_t)7;
+    if (length > UINT32_MAX) {
+        return 0;
+    }
+    if (out == NULL || capacity < RECORD_PREFIX + length) {
+        return RECORD_PREFIX + length;
+    }
+
+    uint32_t word = BLOCK_FILE_MAGIC;
+    memcpy(out, &word, 4);
+    word = (uint32_t)length;
+    memcpy(out + 4, &word, 4);
+    uint8_t* p = out + RECORD_PREFIX;
+    serialize_block_header(block, block->merkle_root, p);
+    word = (uint32_t)rows;
+    memcpy(p + BLOCK_HEADER_SIZE, &word, 4);
+    memset(p + BLOCK_HEADER_SIZE + 4, 0, 4);
+    p += RECORD_FIXED;
+    if (rows > 0) {
+        memcpy(p, block->txs.amounts, rows * sizeof(int64_t));
+        p += rows * sizeof(int64_t);
+        memcpy(p, block->txs.senders, rows * sizeof(uint32_t));
+        p += rows * sizeof(uint32_t);
+        memcpy(p, block->txs.receivers, rows * sizeof(uint32_t));
+        p += rows * sizeof(uint32_t);
+        memcpy(p, block->txs.time_deltas, rows * sizeof(int32_t));
+        p += rows * sizeof(int32_t);
+    }
+    word = first_account;
+    memcpy(p, &word, 4);
+    word = chain->accounts.count - first_account;
+    memcpy(p + 4, &word, 4);
+    p += 8;
+    for (uint32_t id = first_account; id < chain->accounts.count; id++) {
+        const char* name = chain->accounts.names[id];
+        uint16_t len = (uint16_t)strlen(name);
+        memcpy(p, &len, 2);
+        memcpy(p + 2, name, len);
+        p += 2 + len;
+    }
+    memset(p, 0, length - unpadded);
+    return RECORD_PREFIX + length;
+}
+
+/**
+ * @brief Decode a record held in memory (8-byte aligned) without copying it
+ * @return 1 if record holds exactly one well-formed record, 0 otherwise
+ */
+int block_record_parse(const uint8_t* record, size_t size, BlockView* view) {
+    uint64_t next;
+    return parse_record(record, size, 0, view, &next) && next == size;
+}
+
+/**
+ * @brief Append one block record and its index entry (buffered)
+ * @param writer Open writer
+ * @param chain Chain owning the block, for account names
+ * @param block Block to write
+ * @return 1 on success, 0 on I/O error (reopen to drop the partial record), out of
+ *         memory or an account name over 65535 bytes
+ */
+int block_file_append(BlockFileWriter* writer, const Blockchain* chain, const Block* block) {
+    size_t size = block_record_encode(chain, block, writer->accounts_written, NULL, 0);
+    if (size == 0) {
+        return 0;
+    }
+    if (size > writer->scratch_capacity) {
+        free(writer->scratch);
+        writer->scratch = (uint8_t*)aligned_alloc(8, (size + 7) & ~(size_t)7);
+        writer->scratch_capacity = writer->scratch != NULL ? size : 0;
+        if (writer->scratch == NULL) {
+            return 0;
+        }
+    }
+    block_record_encode(chain, block, writer->accounts_written, writer->scratch, writer->scratch_capacity);
+    if (fwrite(writer->scratch, 1, size, writer->data) != size ||
+        fwrite(&writer->offset, sizeof(writer->offset), 1, writer->index) != 1) {
+        return 0;
+    }
+    writer->offset += size;
+    writer->blocks++;
+    writer->accounts_written = chain->accounts.count;
+    return 1;
+}
+
+/**
+ * @brief Make every appended record durable, data before index
+ * @return 1 on success, 0 on I/O error
+ */
+int block_file_flush(BlockFileWriter* writer) {
+    return fflush(writer->data) == 0 && fdatasync(fileno(writer->data)) == 0 && fflush(writer->index) == 0 &&
+           fdatasync(fileno(writer->index)) == 0;
+}
+
+/**
+ * @brief Flush and close both files
+ * @return 1 if everything reached disk, 0 otherwise
+ */
+int block_file_writer_close(BlockFileWriter* writer) {
+    int ok = block_file_flush(writer);
+    ok = fclose(writer->data) == 0 && ok;
+    ok = fclose(writer->index) == 0 && ok;
+    free(writer->scratch);
+    memset(writer, 0, sizeof(*writer));
+    return ok;
+}
+
+/**
+ * @brief Map a whole file read-only (an empty file maps to NULL)
+ * @return 1 on success, 0 if the file cannot be opened or mapped
+ */
+static int map_file(const char* path, const uint8_t** map, size_t* size) {
+    *map = NULL;
+    *size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    int ok = fstat(fd, &st) == 0;
+    if (ok && st.st_size > 0) {
+        void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ok = p != MAP_FAILED;
+        if (ok) {
+            *map = (const uint8_t*)p;
+            *size = (size_t)st.st_size;
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Map a block file (and optionally its index) read-only
+ * @param reader Reader to initialize
+ * @param data_path Block data file
+ * @param index_path Offset index file, or NULL for sequential access only
+ * @return 1 on success, 0 if a file cannot be opened or mapped
+ */
+int block_file_reader_open(BlockFileReader* reader, const char* data_path, const char* index_path) {
+    memset(reader, 0, sizeof(*reader));
+    if (!map_file(data_path, &reader->data, &reader->size)) {
+        return 0;
+    }
+    if (reader->data != NULL) {
+        posix_madvise((void*)reader->data, reader->size, POSIX_MADV_SEQUENTIAL);
+    }
+    if (index_path != NULL && !map_file(index_path, &reader->offsets, &reader->index_size)) {
+        block_file_reader_close(reader);
+        return 0;
+    }
+    reader->count = reader->index_size / 8;
+    return 1;
+}
+
+/**
+ * @brief View block i through the offset index
+ * @return 1 on success, 0 if i is out of range or its record is damaged
+ */
+int block_file_get(const BlockFileReader* reader, size_t i, BlockView* view) {
+    uint64_t next;
+    return i < reader->count && parse_record(reader->data, reader->size, load_u64(reader->offsets + 8 * i), view, &next);
+}
+
+/**
+ * @brief View the record at *cursor and advance it; start from 0
+ * @return 1 if a record was read, 0 at the end of the valid data
+ */
+int block_file_next(const BlockFileReader* reader, uint64_t* cursor, BlockView* view) {
+    uint64_t next;
+    if (reader->data == NULL || !parse_record(reader->data, reader->size, *cursor, view, &next)) {
+        return 0;
+    }
+    *cursor = next;
+    return 1;
+}
+
+/**
+ * @brief Unmap both files
+ */
+void block_file_reader_close(BlockFileReader* reader) {
+    if (reader->data != NULL) {
+        munmap((void*)reader->data, reader->size);
+    }
+    if (reader->offsets != NULL) {
+        munmap((void*)reader->offsets, reader->index_size);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * @brief Restore the account names a record carries, checking they extend the table in order
+ */
+static int load_accounts(Blockchain* chain, const BlockView* view) {
+    const uint8_t* name = view->account_names;
+    char buf[UINT16_MAX + 1];
+    for (uint32_t k = 0; k < view->account_count; k++) {
+        size_t len = (size_t)name[0] | (size_t)name[1] << 8;
+        uint32_t id = view->first_account + k;
+        memcpy(buf, name + 2, len);
+        buf[len] = '\0';
+        name += 2 + len;
+        if (id < chain->accounts.count) {
+            if (strcmp(chain->accounts.names[id], buf) != 0) {
+                return 0;
+            }
+        } else if (id != chain->accounts.count || account_intern(chain, buf) != id) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Append the block a record describes to a chain, restoring its account names
+ *
+ * Copies the columns into the chain's arenas. Without verified_hash the
+ * Merkle root is recomputed and must match the header; with it, the
+ * caller vouches for both and the header values are taken as they are.
+ * The chain's byte limit does not apply.
+ *
+ * @param chain Chain to extend
+ * @param view Decoded record
+ * @param verified_hash Block hash already checked by the caller, or NULL
+ * @return The appended block, or NULL on a mismatch or out of memory
+ */
+Block* block_file_import(Blockchain* chain, const BlockView* view, const uint8_t verified_hash[HASH_LENGTH]) {
+    Block* block = (Block*)arena_alloc(&chain->block_arena, sizeof(Block), alignof(Block));
+    if (block == NULL || !load_accounts(chain, view)) {
+        return NULL;
+    }
+    memset(block, 0, sizeof(*block));
+    block->index = view->index;
+    memcpy(block->previous_hash, view->previous_hash, HASH_LENGTH);
+    block->timestamp = view->timestamp;
+    block->difficulty = view->difficulty;
+    block->nonce = view->nonce;
+
+    size_t limit = chain->max_block_bytes;
+    chain->max_block_bytes = SIZE_MAX;
+    int ok = 1;
+    Transaction batch[LOAD_BATCH];
+    for (uint32_t i = 0; ok && i < view->transaction_count; i += LOAD_BATCH) {
+        uint32_t n = view->transaction_count - i < LOAD_BATCH ? view->transaction_count - i : LOAD_BATCH;
+        for (uint32_t k = 0; k < n; k++) {
+            batch[k].sender = view->senders[i + k];
+            batch[k].receiver = view->receivers[i + k];
+            batch[k].amount = view->amounts[i + k];
+            batch[k].timestamp = view->timestamp + view->time_deltas[i + k];
+        }
+        ok = add_transactions(chain, block, batch, n);
+    }
+    chain->max_block_bytes = limit;
+    if (!ok) {
+        return NULL;
+    }
+    if (verified_hash != NULL) {
+        memcpy(block->merkle_root, view->merkle_root, HASH_LENGTH);
+        memcpy(block->current_hash, verified_hash, HASH_LENGTH);
+    } else {
+        calculate_block_hash(block);
+        if (memcmp(block->merkle_root, view->merkle_root, HASH_LENGTH) != 0) {
+            return NULL;
+        }
+    }
+    return blockchain_index_block(chain, block) ? block : NULL;
+}
+
+/**
+ * @brief Rebuild an empty chain from every valid record of a block file
+ *
+ * Each block's Merkle root is recomputed from its columns and must match
+ * the stored header; run verify_blockchain_parallel for the full check.
+ *
+ * @param reader Open reader
+ * @param chain Empty, initialized chain
+ * @return 1 on success, 0 on a damaged record or out of memory
+ */
+int block_file_load(const BlockFileReader* reader, Blockchain* chain) {
+    if (chain->count != 0) {
+        return 0;
+    }
+    BlockView view;
+    uint64_t cursor = 0;
+    while (block_file_next(reader, &cursor, &view)) {
+        if (block_file_import(chain, &view, NULL) == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Append-only block file with an offset index and a zero-copy mmap reader
+ *
+ * Demonstrates:
+ * - Length-prefixed records in the style of Bitcoin's blk*.dat
+ * - Buffered append writer plus a separate offset index file
+ * - Torn-tail recovery when a writer reopens the files
+ * - Zero-copy iteration: views point straight into the mapped file
+ *
+ * Record layout (little-endian, every record starts 8-byte aligned):
+ *
+ *   magic u32 | payload length u32 | header[BLOCK_HEADER_SIZE] | tx count u32 | reserved u32 |
+ *   amounts i64[n] | senders u32[n] | receivers u32[n] | time deltas i32[n] |
+ *   first account u32 | account count u32 | (name length u16, name bytes)... | zero padding
+ *
+ * Each record carries the account names interned since the previous
+ * record, so IDs can be restored in order. The index file holds one u64
+ * record offset per block.
+ */
+
+#ifndef BLOCK_FILE_H
+#define BLOCK_FILE_H
+
+#include <stdio.h>
+
+#include "blockchain.h"
+
+#define BLOCK_FILE_MAGIC 0x4B4C4243u
+#define BLOCK_FILE_BUFFER (1 << 20)
+
+/**
+ * @brief Appends block records and their offsets
+ */
+typedef struct {
+    FILE* data;
+    FILE* index;
+    uint64_t offset;
+    uint64_t blocks;
+    uint32_t accounts_written;
+    uint8_t* scratch;
+    size_t scratch_capacity;
+} BlockFileWriter;
+
+/**
+ * @brief A block record as pointers into the mapped file
+ *
+ * header uses the serialize_block_header layout; the column pointers
+ * alias the file and stay valid until the reader is closed.
+ */
+typedef struct {
+    const uint8_t* header;
+    int index;
+    const uint8_t* previous_hash;
+    const uint8_t* merkle_root;
+    time_t timestamp;
+    uint32_t difficulty;
+    uint64_t nonce;
+    uint32_t transaction_count;
+    const int64_t* amounts;
+    const uint32_t* senders;
+    const uint32_t* receivers;
+    const int32_t* time_deltas;
+    uint32_t first_account;
+    uint32_t account_count;
+    const uint8_t* account_names;
+} BlockView;
+
+/**
+ * @brief Read-only mapping of a block file and its index
+ */
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    const uint8_t* offsets;
+    size_t index_size;
+    size_t count;
+} BlockFileReader;
+
+/**
+ * @brief Open (or create) a block file for appending
+ *
+ * Drops a torn trailing record and brings the index back in line with
+ * the data file before returning.
+ */
+int block_file_writer_open(BlockFileWriter* writer, const char* data_path, const char* index_path);
+int block_file_append(BlockFileWriter* writer, const Blockchain* chain, const Block* block);
+int block_file_flush(BlockFileWriter* writer);
+int block_file_writer_close(BlockFileWriter* writer);
+
+int block_file_reader_open(BlockFileReader* reader, const char* data_path, const char* index_path);
+int block_file_get(const BlockFileReader* reader, size_t i, BlockView* view);
+int block_file_next(const BlockFileReader* reader, uint64_t* cursor, BlockView* view);
+void block_file_reader_close(BlockFileReader* reader);
+
+/**
+ * @brief Encode a block as one record in memory (the same bytes the writer appends)
+ */
+size_t block_record_encode(const Blockchain* chain, const Block* block, uint32_t first_account, uint8_t* out,
+                           size_t capacity);
+int block_record_parse(const uint8_t* record, size_t size, BlockView* view);
+
+/**
+ * @brief Append the block a record describes to a chain
+ */
+Block* block_file_import(Blockchain* chain, const BlockView* view, const uint8_t verified_hash[HASH_LENGTH]);
+
+/**
+ * @brief Rebuild an empty chain from every record of a block file
+ */
+int block_file_load(const BlockFileReader* reader, Blockchain* chain);
+
+#endif
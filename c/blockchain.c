@@ -0,0 +1,1074 @@
+/**
+ * @file
+ * @brief Blockchain implementation (see blockchain.h)
+ */
+
+#include "blockchain.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define VERIFY_BATCH 64
+
+/**
+ * @brief Hash table position for a digest
+ *
+ * Uses the trailing bytes: proof of work forces the leading bytes to zero,
+ * which would put every mined block in one probe cluster.
+ */
+static size_t digest_slot(const uint8_t hash[HASH_LENGTH]) {
+    uint64_t word;
+    memcpy(&word, hash + HASH_LENGTH - sizeof(word), sizeof(word));
+    return (size_t)word;
+}
+
+/**
+ * @brief Format a digest as lowercase hex
+ * @param hash Digest
+ * @param out Receives 2 * HASH_LENGTH characters and a terminator
+ */
+void hash_to_hex(const uint8_t hash[HASH_LENGTH], char out[2 * HASH_LENGTH + 1]) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < HASH_LENGTH; i++) {
+        out[2 * i] = digits[hash[i] >> 4];
+        out[2 * i + 1] = digits[hash[i] & 15];
+    }
+    out[2 * HASH_LENGTH] = '\0';
+}
+
+/**
+ * @brief Allocate size bytes aligned to align (a power of two <= max_align_t)
+ * @param arena Arena
+ * @param size Bytes to allocate
+ * @param align Alignment
+ * @return Memory valid until arena_release, or NULL if out of memory
+ */
+void* arena_alloc(Arena* arena, size_t size, size_t align) {
+    ArenaChunk* chunk = arena->head;
+    if (chunk != NULL) {
+        size_t offset = (chunk->used + align - 1) & ~(align - 1);
+        if (offset + size <= chunk->size) {
+            chunk->used = offset + size;
+            return chunk->data + offset;
+        }
+    }
+
+    size_t capacity = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+    chunk = (ArenaChunk*)malloc(sizeof(ArenaChunk) + capacity);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->next = arena->head;
+    chunk->used = size;
+    chunk->size = capacity;
+    arena->head = chunk;
+    return chunk->data;
+}
+
+/**
+ * @brief Free every chunk of an arena
+ * @param arena Arena
+ */
+void arena_release(Arena* arena) {
+    ArenaChunk* chunk = arena->head;
+    while (chunk != NULL) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head = NULL;
+}
+
+/**
+ * @brief Initialize an empty chain with the default block byte limit
+ * @param chain Chain handle
+ */
+void blockchain_init(Blockchain* chain) {
+    memset(chain, 0, sizeof(*chain));
+    chain->max_block_bytes = DEFAULT_MAX_BLOCK_BYTES;
+}
+
+/**
+ * @brief Insert a block into the hash table (which must have room)
+ */
+static void hash_slots_insert(Block** slots, size_t capacity, Block* block) {
+    size_t mask = capacity - 1;
+    size_t i = digest_slot(block->current_hash) & mask;
+    while (slots[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = block;
+}
+
+/**
+ * @brief Register a hashed block as the new tail in both indexes
+ * @return 1 on success, 0 if out of memory
+ */
+int blockchain_index_block(Blockchain* chain, Block* block) {
+    if (chain->count == chain->capacity) {
+        size_t capacity = chain->capacity ? chain->capacity * 2 : 64;
+        Block** blocks = (Block**)realloc(chain->blocks, capacity * sizeof(Block*));
+        if (blocks == NULL) {
+            return 0;
+        }
+        chain->blocks = blocks;
+        chain->capacity = capacity;
+    }
+    if ((chain->count + 1) * 2 > chain->hash_capacity) {
+        size_t capacity = chain->hash_capacity ? chain->hash_capacity * 2 : 128;
+        Block** slots = (Block**)calloc(capacity, sizeof(Block*));
+        if (slots == NULL) {
+            return 0;
+        }
+        for (size_t i = 0; i < chain->count; i++) {
+            hash_slots_insert(slots, capacity, chain->blocks[i]);
+        }
+        free(chain->hash_slots);
+        chain->hash_slots = slots;
+        chain->hash_capacity = capacity;
+    }
+    chain->blocks[chain->count++] = block;
+    hash_slots_insert(chain->hash_slots, chain->hash_capacity, block);
+    if (chain->tail != NULL) {
+        chain->tail->next = block;
+    } else {
+        chain->head = block;
+    }
+    chain->tail = block;
+    return 1;
+}
+
+/**
+ * @brief Look up a block by index in O(1)
+ * @param chain Chain handle
+ * @param index Block index
+ * @return Block, or NULL if out of range
+ */
+Block* blockchain_get(const Blockchain* chain, int index) {
+    if (index < 0 || (size_t)index >= chain->count) {
+        return NULL;
+    }
+    return chain->blocks[index];
+}
+
+/**
+ * @brief Look up a block by its current_hash in expected O(1)
+ * @param chain Chain handle
+ * @param hash Digest as stored in current_hash
+ * @return Lowest-index block with that hash, or NULL
+ */
+Block* blockchain_find_by_hash(const Blockchain* chain, const uint8_t hash[HASH_LENGTH]) {
+    if (chain->hash_capacity == 0) {
+        return NULL;
+    }
+    Block* found = NULL;
+    size_t mask = chain->hash_capacity - 1;
+    for (size_t i = digest_slot(hash) & mask; chain->hash_slots[i] != NULL; i = (i + 1) & mask) {
+        Block* block = chain->hash_slots[i];
+        if (memcmp(block->current_hash, hash, HASH_LENGTH) == 0 && (found == NULL || block->index < found->index)) {
+            found = block;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief FNV-1a hash of an account name
+ */
+static size_t name_slot(const char* name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (; *name != '\0'; name++) {
+        h = (h ^ (uint8_t)*name) * 1099511628211ULL;
+    }
+    return (size_t)h;
+}
+
+/**
+ * @brief ID of an account name, assigning the next ID on first use
+ * @param chain Chain owning the account table
+ * @param name Account name
+ * @return Account ID, or INVALID_ACCOUNT if out of memory
+ */
+uint32_t account_intern(Blockchain* chain, const char* name) {
+    AccountTable* table = &chain->accounts;
+    size_t mask = table->slot_capacity - 1;
+    if (table->slot_capacity != 0) {
+        for (size_t i = name_slot(name) & mask; table->slots[i] != 0; i = (i + 1) & mask) {
+            if (strcmp(table->names[table->slots[i] - 1], name) == 0) {
+                return table->slots[i] - 1;
+            }
+        }
+    }
+    if (table->count == INVALID_ACCOUNT - 1) {
+        return INVALID_ACCOUNT;
+    }
+    if (table->count == table->capacity) {
+        uint32_t capacity = table->capacity ? table->capacity * 2 : 64;
+        const char** names = (const char**)realloc(table->names, capacity * sizeof(const char*));
+        if (names == NULL) {
+            return INVALID_ACCOUNT;
+        }
+        table->names = names;
+        table->capacity = capacity;
+    }
+    if (((size_t)table->count + 1) * 2 > table->slot_capacity) {
+        size_t capacity = table->slot_capacity ? table->slot_capacity * 2 : 128;
+        uint32_t* slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+        if (slots == NULL) {
+            return INVALID_ACCOUNT;
+        }
+        for (uint32_t id = 0; id < table->count; id++) {
+            size_t i = name_slot(table->names[id]) & (capacity - 1);
+            while (slots[i] != 0) {
+                i = (i + 1) & (capacity - 1);
+            }
+            slots[i] = id + 1;
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->slot_capacity = capacity;
+        mask = capacity - 1;
+    }
+    size_t len = strlen(name) + 1;
+    char* copy = (char*)arena_alloc(&chain->name_arena, len, 1);
+    if (copy == NULL) {
+        return INVALID_ACCOUNT;
+    }
+    memcpy(copy, name, len);
+    uint32_t id = table->count++;
+    table->names[id] = copy;
+    size_t i = name_slot(name) & mask;
+    while (table->slots[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    table->slots[i] = id + 1;
+    return id;
+}
+
+/**
+ * @brief Name of an interned account
+ * @return Name, or NULL for an unknown ID
+ */
+const char* account_name(const Blockchain* chain, uint32_t id) {
+    return id < chain->accounts.count ? chain->accounts.names[id] : NULL;
+}
+
+/**
+ * @brief Decode one row of a block's transaction columns
+ * @param block Block
+ * @param i Row, below transaction_count
+ * @param out Decoded transaction
+ */
+void block_transaction(const Block* block, int i, Transaction* out) {
+    out->sender = block->txs.senders[i];
+    out->receiver = block->txs.receivers[i];
+    out->amount = block->txs.amounts[i];
+    out->timestamp = block->timestamp + block->txs.time_deltas[i];
+}
+
+/**
+ * @brief Move a block's columns into a span with room for capacity rows
+ * @return 1 on success, 0 if out of memory
+ */
+static int reserve_transactions(Blockchain* chain, Block* block, int capacity) {
+    size_t rows = (size_t)capacity;
+    size_t count = (size_t)block->transaction_count;
+    unsigned char* span = (unsigned char*)arena_alloc(&chain->tx_arena, rows * TRANSACTION_ROW_SIZE, alignof(int64_t));
+    if (span == NULL) {
+        return 0;
+    }
+    TransactionColumns txs;
+    txs.amounts = (int64_t*)span;
+    txs.senders = (uint32_t*)(txs.amounts + rows);
+    txs.receivers = txs.senders + rows;
+    txs.time_deltas = (int32_t*)(txs.receivers + rows);
+    if (count > 0) {
+        memcpy(txs.amounts, block->txs.amounts, count * sizeof(int64_t));
+        memcpy(txs.senders, block->txs.senders, count * sizeof(uint32_t));
+        memcpy(txs.receivers, block->txs.receivers, count * sizeof(uint32_t));
+        memcpy(txs.time_deltas, block->txs.time_deltas, count * sizeof(int32_t));
+    }
+    block->txs = txs;
+    block->transaction_capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Whether a block has room for n more rows under the chain's byte limit
+ */
+static int block_has_room(const Blockchain* chain, const Block* block, size_t n) {
+    size_t rows = (size_t)block->transaction_count;
+    if (n > (size_t)INT_MAX / 2 - rows) {
+        return 0;
+    }
+    return (rows + n) * TRANSACTION_ROW_SIZE <= chain->max_block_bytes;
+}
+
+/**
+ * @brief Append transactions to a block without printing
+ *
+ * Columns grow by doubling; abandoned spans stay in the transaction
+ * arena until the chain is freed. Either every transaction is added or
+ * none is.
+ *
+ * @param chain Chain owning the block and the accounts
+ * @param block Block being built
+ * @param txs Transactions with interned accounts and absolute timestamps
+ * @param n Number of transactions
+ * @return 1 if added, 0 if over the byte limit, a transaction is invalid or out of memory
+ */
+int add_transactions(Blockchain* chain, Block* block, const Transaction* txs, size_t n) {
+    if (!block_has_room(chain, block, n)) {
+        return 0;
+    }
+    for (size_t k = 0; k < n; k++) {
+        time_t delta = txs[k].timestamp - block->timestamp;
+        if (txs[k].amount < 0 || txs[k].sender >= chain->accounts.count || txs[k].receiver >= chain->accounts.count ||
+            delta < INT32_MIN || delta > INT32_MAX) {
+            return 0;
+        }
+    }
+    size_t needed = (size_t)block->transaction_count + n;
+    if (needed > (size_t)block->transaction_capacity) {
+        size_t capacity = block->transaction_capacity ? (size_t)block->transaction_capacity : 16;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        if (!reserve_transactions(chain, block, (int)capacity)) {
+            return 0;
+        }
+    }
+    for (size_t k = 0; k < n; k++) {
+        int i = block->transaction_count++;
+        block->txs.senders[i] = txs[k].sender;
+        block->txs.receivers[i] = txs[k].receiver;
+        block->txs.amounts[i] = txs[k].amount;
+        block->txs.time_deltas[i] = (int32_t)(txs[k].timestamp - block->timestamp);
+    }
+    return 1;
+}
+
+/**
+ * @brief Add transaction to block
+ * @param chain Chain owning the block
+ * @param block Pointer to block
+ * @param sender Transaction sender
+ * @param receiver Transaction receiver
+ * @param amount Transaction amount in units of 1 / AMOUNT_SCALE coin (not negative)
+ * @return 1 if added, 0 if the block is full, amount is negative or out of memory
+ */
+int add_transaction(Blockchain* chain, Block* block, const char* sender, const char* receiver, int64_t amount) {
+    if (!block_has_room(chain, block, 1)) {
+        printf("Block full! Cannot add transaction.\n");
+        return 0;
+    }
+    Transaction tx;
+    tx.sender = account_intern(chain, sender);
+    tx.receiver = account_intern(chain, receiver);
+    tx.amount = amount;
+    tx.timestamp = time(NULL);
+    if (tx.sender == INVALID_ACCOUNT || tx.receiver == INVALID_ACCOUNT || !add_transactions(chain, block, &tx, 1)) {
+        return 0;
+    }
+    printf("Transaction added: %s -> %s (%lld.%08lld BTC)\n", sender, receiver,
+           (long long)(amount / AMOUNT_SCALE), (long long)(amount % AMOUNT_SCALE));
+    return 1;
+}
+
+/**
+ * @brief Total amount an account sent plus received across the chain
+ *
+ * Reads only the sender, receiver and amount columns of each block.
+ *
+ * @param chain Chain handle
+ * @param account Account ID
+ * @return Volume in units of 1 / AMOUNT_SCALE coin
+ */
+int64_t account_volume(const Blockchain* chain, uint32_t account) {
+    int64_t volume = 0;
+    for (size_t b = 0; b < chain->count; b++) {
+        const Block* block = chain->blocks[b];
+        for (int i = 0; i < block->transaction_count; i++) {
+            if (block->txs.senders[i] == account || block->txs.receivers[i] == account) {
+                volume += block->txs.amounts[i];
+            }
+        }
+    }
+    return volume;
+}
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void put_le64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+/**
+ * @brief Merkle leaf for a transaction: SHA-256 of 0x00 and its canonical encoding
+ *
+ * Encoding: sender and receiver IDs as little-endian 32-bit words, then
+ * amount and absolute timestamp as little-endian 64-bit words.
+ *
+ * @param tx Transaction
+ * @param out Leaf digest
+ */
+void transaction_leaf_hash(const Transaction* tx, uint8_t out[HASH_LENGTH]) {
+    uint8_t buf[25];
+    buf[0] = 0x00;
+    put_le32(buf + 1, tx->sender);
+    put_le32(buf + 5, tx->receiver);
+    put_le64(buf + 9, (uint64_t)tx->amount);
+    put_le64(buf + 17, (uint64_t)(int64_t)tx->timestamp);
+    sha256(buf, sizeof(buf), out);
+}
+
+/**
+ * @brief Merkle leaf of row i of a block
+ */
+static void block_leaf_hash(const Block* block, int i, uint8_t out[HASH_LENGTH]) {
+    Transaction tx;
+    block_transaction(block, i, &tx);
+    transaction_leaf_hash(&tx, out);
+}
+
+/**
+ * @brief Interior Merkle node: SHA-256 of 0x01, left and right (out may alias either)
+ */
+static void merkle_node_hash(const uint8_t left[HASH_LENGTH], const uint8_t right[HASH_LENGTH],
+                             uint8_t out[HASH_LENGTH]) {
+    uint8_t buf[1 + 2 * HASH_LENGTH];
+    buf[0] = 0x01;
+    memcpy(buf + 1, left, HASH_LENGTH);
+    memcpy(buf + 1 + HASH_LENGTH, right, HASH_LENGTH);
+    sha256(buf, sizeof(buf), out);
+}
+
+/**
+ * @brief Merkle root of a block's transactions, all zeros for an empty block
+ *
+ * Incremental: keeps one pending subtree root per set bit of the leaf
+ * count, so no allocation is needed. Folding the pending roots right to
+ * left at the end equals promoting odd nodes level by level.
+ *
+ * @param block Block
+ * @param out Root digest
+ */
+void calculate_merkle_root(const Block* block, uint8_t out[HASH_LENGTH]) {
+    uint8_t pending[MERKLE_MAX_DEPTH][HASH_LENGTH];
+    size_t depth = 0;
+    for (size_t i = 0; i < (size_t)block->transaction_count; i++) {
+        block_leaf_hash(block, (int)i, pending[depth++]);
+        for (size_t n = i + 1; (n & 1) == 0; n >>= 1) {
+            merkle_node_hash(pending[depth - 2], pending[depth - 1], pending[depth - 2]);
+            depth--;
+        }
+    }
+    if (depth == 0) {
+        memset(out, 0, HASH_LENGTH);
+        return;
+    }
+    for (; depth > 1; depth--) {
+        merkle_node_hash(pending[depth - 2], pending[depth - 1], pending[depth - 2]);
+    }
+    memcpy(out, pending[0], HASH_LENGTH);
+}
+
+/**
+ * @brief Build the full Merkle tree of a block's transactions
+ * @param block Block with at least one transaction
+ * @param tree Receives the tree; release with merkle_tree_free
+ * @return 1 on success, 0 if the block is empty or out of memory
+ */
+int merkle_tree_build(const Block* block, MerkleTree* tree) {
+    size_t width = (size_t)block->transaction_count;
+    size_t total = 0;
+    for (size_t w = width; w > 1; w = (w + 1) / 2) {
+        total += w;
+    }
+    total++;
+    tree->nodes = NULL;
+    tree->leaf_count = 0;
+    if (width == 0) {
+        return 0;
+    }
+    tree->nodes = (uint8_t (*)[HASH_LENGTH])malloc(total * HASH_LENGTH);
+    if (tree->nodes == NULL) {
+        return 0;
+    }
+    tree->leaf_count = width;
+    for (size_t i = 0; i < width; i++) {
+        block_leaf_hash(block, (int)i, tree->nodes[i]);
+    }
+    for (size_t level = 0; width > 1; width = (width + 1) / 2) {
+        uint8_t (*parents)[HASH_LENGTH] = tree->nodes + level + width;
+        for (size_t i = 0; i + 1 < width; i += 2) {
+            merkle_node_hash(tree->nodes[level + i], tree->nodes[level + i + 1], parents[i / 2]);
+        }
+        if (width & 1) {
+            memcpy(parents[width / 2], tree->nodes[level + width - 1], HASH_LENGTH);
+        }
+        level += width;
+    }
+    return 1;
+}
+
+/**
+ * @brief Root of a built tree
+ */
+const uint8_t* merkle_tree_root(const MerkleTree* tree) {
+    size_t offset = 0;
+    for (size_t w = tree->leaf_count; w > 1; w = (w + 1) / 2) {
+        offset += w;
+    }
+    return tree->nodes[offset];
+}
+
+/**
+ * @brief Extract the inclusion proof for one transaction in O(log n)
+ * @param tree Built tree
+ * @param tx_index Index of the transaction in the block
+ * @param proof Receives the proof
+ * @return 1 on success, 0 if tx_index is out of range
+ */
+int merkle_tree_proof(const MerkleTree* tree, size_t tx_index, MerkleProof* proof) {
+    if (tx_index >= tree->leaf_count) {
+        return 0;
+    }
+    proof->leaf_index = tx_index;
+    proof->leaf_count = tree->leaf_count;
+    proof->sibling_count = 0;
+    size_t level = 0;
+    size_t index = tx_index;
+    for (size_t width = tree->leaf_count; width > 1; width = (width + 1) / 2) {
+        if ((index ^ 1) < width) {
+            memcpy(proof->siblings[proof->sibling_count++], tree->nodes[level + (index ^ 1)], HASH_LENGTH);
+        }
+        level += width;
+        index >>= 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Free a tree built by merkle_tree_build
+ */
+void merkle_tree_free(MerkleTree* tree) {
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->leaf_count = 0;
+}
+
+/**
+ * @brief Check that a transaction is included under a Merkle root in O(log n)
+ * @param tx Transaction claimed to be in the block
+ * @param proof Proof from merkle_tree_proof
+ * @param root Merkle root from the block header
+ * @return 1 if the proof is valid, 0 otherwise
+ */
+int verify_merkle_proof(const Transaction* tx, const MerkleProof* proof, const uint8_t root[HASH_LENGTH]) {
+    if (proof->leaf_index >= proof->leaf_count || proof->sibling_count > MERKLE_MAX_DEPTH) {
+        return 0;
+    }
+    uint8_t hash[HASH_LENGTH];
+    transaction_leaf_hash(tx, hash);
+    size_t used = 0;
+    size_t index = proof->leaf_index;
+    for (size_t width = proof->leaf_count; width > 1; width = (width + 1) / 2) {
+        if ((index ^ 1) < width) {
+            if (used == proof->sibling_count) {
+                return 0;
+            }
+            const uint8_t* sibling = proof->siblings[used++];
+            if (index & 1) {
+                merkle_node_hash(sibling, hash, hash);
+            } else {
+                merkle_node_hash(hash, sibling, hash);
+            }
+        }
+        index >>= 1;
+    }
+    return used == proof->sibling_count && memcmp(hash, root, HASH_LENGTH) == 0;
+}
+
+/**
+ * @brief Canonical little-endian header: index, previous_hash, merkle_root, timestamp,
+ * difficulty, nonce
+ * @param block Block
+ * @param merkle_root Transaction root to place in the header
+ * @param out Serialized header
+ */
+void serialize_block_header(const Block* block, const uint8_t merkle_root[HASH_LENGTH],
+                            uint8_t out[BLOCK_HEADER_SIZE]) {
+    put_le32(out, (uint32_t)block->index);
+    memcpy(out + 4, block->previous_hash, HASH_LENGTH);
+    memcpy(out + 4 + HASH_LENGTH, merkle_root, HASH_LENGTH);
+    put_le64(out + 4 + 2 * HASH_LENGTH, (uint64_t)(int64_t)block->timestamp);
+    put_le32(out + 12 + 2 * HASH_LENGTH, block->difficulty);
+    put_le64(out + 16 + 2 * HASH_LENGTH, block->nonce);
+}
+
+/**
+ * @brief Whether a digest has at least difficulty leading zero bits
+ */
+int hash_meets_difficulty(const uint8_t hash[HASH_LENGTH], uint32_t difficulty) {
+    if (difficulty > 8 * HASH_LENGTH) {
+        return 0;
+    }
+    uint32_t i = 0;
+    for (; i + 8 <= difficulty; i += 8) {
+        if (hash[i / 8] != 0) {
+            return 0;
+        }
+    }
+    return i == difficulty || (hash[i / 8] >> (8 - (difficulty - i))) == 0;
+}
+
+/**
+ * @brief Calculate block hash (and the Merkle root it commits to)
+ * @param block Block to hash
+ */
+void calculate_block_hash(Block* block) {
+    uint8_t header[BLOCK_HEADER_SIZE];
+    calculate_merkle_root(block, block->merkle_root);
+    serialize_block_header(block, block->merkle_root, header);
+    sha256(header, sizeof(header), block->current_hash);
+}
+
+/**
+ * @brief Recompute the hashes of many blocks from their contents, eight headers per pass
+ *
+ * Stored merkle_root and current_hash fields are ignored, so the result
+ * can be compared against them.
+ *
+ * @param blocks Blocks to hash
+ * @param count Number of blocks
+ * @param out out[i] receives the hash of blocks[i]
+ */
+void compute_block_hashes(Block* const* blocks, size_t count, uint8_t (*out)[HASH_LENGTH]) {
+    uint8_t headers[8][BLOCK_HEADER_SIZE];
+    const uint8_t* lanes[8];
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        for (int lane = 0; lane < 8; lane++) {
+            uint8_t merkle_root[HASH_LENGTH];
+            calculate_merkle_root(blocks[i + lane], merkle_root);
+            serialize_block_header(blocks[i + lane], merkle_root, headers[lane]);
+            lanes[lane] = headers[lane];
+        }
+        sha256_x8(lanes, BLOCK_HEADER_SIZE, out + i);
+    }
+    for (; i < count; i++) {
+        uint8_t merkle_root[HASH_LENGTH];
+        calculate_merkle_root(blocks[i], merkle_root);
+        serialize_block_header(blocks[i], merkle_root, headers[0]);
+        sha256(headers[0], BLOCK_HEADER_SIZE, out[i]);
+    }
+}
+
+/**
+ * @brief Search state shared by the mining workers of one block
+ */
+typedef struct {
+    uint8_t header[BLOCK_HEADER_SIZE];
+    uint32_t difficulty;
+    uint64_t stride;
+    atomic_int found;
+    uint64_t nonce;
+} MiningJob;
+
+typedef struct {
+    MiningJob* job;
+    uint64_t first;
+    uint64_t hashes;
+} MiningWorker;
+
+static void* mining_worker(void* arg) {
+    MiningWorker* worker = (MiningWorker*)arg;
+    MiningJob* job = worker->job;
+    uint8_t headers[8][BLOCK_HEADER_SIZE];
+    uint8_t hashes[8][HASH_LENGTH];
+    const uint8_t* lanes[8];
+    for (int lane = 0; lane < 8; lane++) {
+        memcpy(headers[lane], job->header, BLOCK_HEADER_SIZE);
+        lanes[lane] = headers[lane];
+    }
+    // Worker w owns nonces w * 8 + k * stride + lane
+    for (uint64_t base = worker->first; !atomic_load_explicit(&job->found, memory_order_relaxed);
+         base += job->stride) {
+        for (int lane = 0; lane < 8; lane++) {
+            put_le64(headers[lane] + BLOCK_HEADER_SIZE - 8, base + (uint64_t)lane);
+        }
+        sha256_x8(lanes, BLOCK_HEADER_SIZE, hashes);
+        worker->hashes += 8;
+        for (int lane = 0; lane < 8; lane++) {
+            int expected = 0;
+            if (hash_meets_difficulty(hashes[lane], job->difficulty) &&
+                atomic_compare_exchange_strong(&job->found, &expected, 1)) {
+                job->nonce = base + (uint64_t)lane;
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+static double elapsed_seconds(const struct timespec* since) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - since->tv_sec) + (double)(now.tv_nsec - since->tv_nsec) * 1e-9;
+}
+
+/**
+ * @brief Find a nonce whose block hash has difficulty leading zero bits
+ *
+ * Sets block->difficulty, block->nonce, merkle_root and current_hash.
+ * Each worker tries eight consecutive nonces per sha256_x8 pass; all of
+ * them stop once any one finds a solution.
+ *
+ * @param block Block with its transactions in place
+ * @param difficulty Required leading zero bits (at most 64)
+ * @param threads Worker threads (values below 1 mean 1)
+ * @param stats Counters to add this search to, or NULL
+ * @return 1 once mined, 0 if difficulty is out of range
+ */
+int mine_block(Block* block, uint32_t difficulty, int threads, MiningStats* stats) {
+    if (difficulty > 64) {
+        return 0;
+    }
+    size_t workers = threads < 1 ? 1 : (size_t)threads;
+    MiningWorker single;
+    pthread_t single_tid;
+    MiningWorker* pool = &single;
+    pthread_t* tids = &single_tid;
+    if (workers > 1) {
+        pool = (MiningWorker*)calloc(workers, sizeof(MiningWorker));
+        tids = (pthread_t*)calloc(workers, sizeof(pthread_t));
+        if (pool == NULL || tids == NULL) {
+            free(pool);
+            free(tids);
+            pool = &single;
+            tids = &single_tid;
+            workers = 1;
+        }
+    }
+
+    MiningJob job;
+    block->difficulty = difficulty;
+    block->nonce = 0;
+    calculate_merkle_root(block, block->merkle_root);
+    serialize_block_header(block, block->merkle_root, job.header);
+    job.difficulty = difficulty;
+    job.stride = 8 * (uint64_t)workers;
+    atomic_init(&job.found, 0);
+    job.nonce = 0;
+    for (size_t w = 0; w < workers; w++) {
+        pool[w].job = &job;
+        pool[w].first = 8 * (uint64_t)w;
+        pool[w].hashes = 0;
+    }
+
+    // Worker 0 runs on the calling thread. A worker that fails to start
+    // leaves its slice unsearched, which only lengthens the expected search.
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    size_t started = 1;
+    while (started < workers && pthread_create(&tids[started], NULL, mining_worker, &pool[started]) == 0) {
+        started++;
+    }
+    mining_worker(&pool[0]);
+    for (size_t w = 1; w < started; w++) {
+        pthread_join(tids[w], NULL);
+    }
+    double seconds = elapsed_seconds(&start);
+
+    block->nonce = job.nonce;
+    calculate_block_hash(block);
+    if (stats != NULL) {
+        for (size_t w = 0; w < started; w++) {
+            stats->hashes += pool[w].hashes;
+        }
+        stats->seconds += seconds;
+        stats->threads = (int)started;
+    }
+    if (pool != &single) {
+        free(pool);
+        free(tids);
+    }
+    return 1;
+}
+
+/**
+ * @brief Hash rate per mining thread over everything recorded in stats
+ */
+double mining_hashes_per_second_per_core(const MiningStats* stats) {
+    if (stats->seconds <= 0 || stats->threads <= 0) {
+        return 0;
+    }
+    return (double)stats->hashes / stats->seconds / stats->threads;
+}
+
+/**
+ * @brief Print block details
+ * @param chain Chain owning the block, for account names
+ * @param block Block to print
+ */
+void print_block(const Blockchain* chain, const Block* block) {
+    printf("\n=== BLOCK #%d ===\n", block->index);
+    char hex[2 * HASH_LENGTH + 1];
+    hash_to_hex(block->previous_hash, hex);
+    printf("Previous Hash: %s\n", hex);
+    hash_to_hex(block->current_hash, hex);
+    printf("Current Hash: %s\n", hex);
+    hash_to_hex(block->merkle_root, hex);
+    printf("Merkle Root: %s\n", hex);
+    printf("Timestamp: %ld\n", (long)block->timestamp);
+    printf("Difficulty: %u, Nonce: %llu\n", (unsigned)block->difficulty, (unsigned long long)block->nonce);
+    printf("Transactions: %d\n", block->transaction_count);
+
+    for (int i = 0; i < block->transaction_count; i++) {
+        int64_t amount = block->txs.amounts[i];
+        printf("  %s -> %s (%lld.%08lld BTC)\n",
+               account_name(chain, block->txs.senders[i]),
+               account_name(chain, block->txs.receivers[i]),
+               (long long)(amount / AMOUNT_SCALE), (long long)(amount % AMOUNT_SCALE));
+    }
+    printf("===================\n");
+}
+
+/**
+ * @brief Create genesis block
+ * @param chain Empty chain handle
+ * @return Genesis block, or NULL if out of memory
+ */
+Block* create_genesis_block(Blockchain* chain) {
+    Block* genesis = (Block*)arena_alloc(&chain->block_arena, sizeof(Block), alignof(Block));
+    if (genesis == NULL) {
+        return NULL;
+    }
+    genesis->index = 0;
+    memset(genesis->previous_hash, 0, HASH_LENGTH);
+    memset(&genesis->txs, 0, sizeof(genesis->txs));
+    genesis->transaction_count = 0;
+    genesis->transaction_capacity = 0;
+    genesis->timestamp = time(NULL);
+    genesis->difficulty = 0;
+    genesis->nonce = 0;
+    genesis->next = NULL;
+    calculate_block_hash(genesis);
+    if (!blockchain_index_block(chain, genesis)) {
+        return NULL;
+    }
+    printf("Genesis block created.\n");
+    return genesis;
+}
+
+/**
+ * @brief Add new block to blockchain in O(1)
+ * @param chain Chain handle with a genesis block
+ * @return New block, or NULL if out of memory
+ */
+Block* add_block(Blockchain* chain) {
+    Block* last_block = chain->tail;
+
+    // Create new block
+    Block* new_block = (Block*)arena_alloc(&chain->block_arena, sizeof(Block), alignof(Block));
+    if (new_block == NULL) {
+        return NULL;
+    }
+    new_block->index = last_block->index + 1;
+    memcpy(new_block->previous_hash, last_block->current_hash, HASH_LENGTH);
+    memset(&new_block->txs, 0, sizeof(new_block->txs));
+    new_block->transaction_count = 0;
+    new_block->transaction_capacity = 0;
+    new_block->timestamp = time(NULL);
+    new_block->difficulty = 0;
+    new_block->nonce = 0;
+    new_block->next = NULL;
+
+    // Add a sample transaction
+    add_transaction(chain, new_block, "Alice", "Bob", 3 * AMOUNT_SCALE / 2);
+    add_transaction(chain, new_block, "Charlie", "Dave", 3 * AMOUNT_SCALE / 4);
+
+    // Calculate hash, mining it when the chain has a difficulty target
+    if (chain->difficulty > 0) {
+        if (!mine_block(new_block, chain->difficulty, chain->mining_threads, &chain->mining)) {
+            return NULL;
+        }
+    } else {
+        calculate_block_hash(new_block);
+    }
+
+    if (!blockchain_index_block(chain, new_block)) {
+        return NULL;
+    }
+    printf("Block #%d added to blockchain.\n", new_block->index);
+    return new_block;
+}
+
+/**
+ * @brief One worker's slice of a parallel verification
+ *
+ * Links inside [begin, end) are checked by the worker; the link into
+ * begin is left to the stitch step, which compares it against the
+ * previous range's recomputed last_hash.
+ */
+typedef struct {
+    const Blockchain* chain;
+    size_t begin;
+    size_t end;
+    size_t first_bad;
+    uint8_t last_hash[HASH_LENGTH];
+} VerifyRange;
+
+static void* verify_range(void* arg) {
+    VerifyRange* range = (VerifyRange*)arg;
+    Block* const* blocks = range->chain->blocks;
+    uint8_t hashes[VERIFY_BATCH][HASH_LENGTH];
+    range->first_bad = SIZE_MAX;
+    for (size_t i = range->begin; i < range->end; i += VERIFY_BATCH) {
+        size_t n = range->end - i < VERIFY_BATCH ? range->end - i : VERIFY_BATCH;
+        compute_block_hashes(blocks + i, n, hashes);
+        for (size_t j = 0; j < n; j++) {
+            const Block* block = blocks[i + j];
+            const uint8_t* previous = j > 0 ? hashes[j - 1] : range->last_hash;
+            if ((size_t)block->index != i + j || memcmp(block->current_hash, hashes[j], HASH_LENGTH) != 0 ||
+                !hash_meets_difficulty(hashes[j], block->difficulty) ||
+                (i + j > range->begin && memcmp(block->previous_hash, previous, HASH_LENGTH) != 0)) {
+                range->first_bad = i + j;
+                return NULL;
+            }
+        }
+        memcpy(range->last_hash, hashes[n - 1], HASH_LENGTH);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Recompute every block hash and check difficulty and linkage on several threads
+ *
+ * The chain is split into one contiguous index range per thread; each
+ * range is validated independently and the seams are checked afterwards.
+ *
+ * @param chain Chain handle
+ * @param threads Worker threads (values below 1 mean 1)
+ * @return Index of the first bad block, or -1 if the chain is valid
+ */
+int verify_blockchain_parallel(const Blockchain* chain, int threads) {
+    size_t count = chain->count;
+    size_t workers = threads < 1 ? 1 : (size_t)threads;
+    if (workers > count) {
+        workers = count ? count : 1;
+    }
+    VerifyRange single;
+    pthread_t single_tid;
+    int single_started;
+    VerifyRange* ranges = &single;
+    pthread_t* tids = &single_tid;
+    int* started = &single_started;
+    if (workers > 1) {
+        ranges = (VerifyRange*)calloc(workers, sizeof(VerifyRange));
+        tids = (pthread_t*)calloc(workers, sizeof(pthread_t));
+        started = (int*)calloc(workers, sizeof(int));
+        if (ranges == NULL || tids == NULL || started == NULL) {
+            // Out of memory: fall back to a single range on this thread
+            free(ranges);
+            free(tids);
+            free(started);
+            ranges = &single;
+            tids = &single_tid;
+            started = &single_started;
+            workers = 1;
+        }
+    }
+    for (size_t w = 0; w < workers; w++) {
+        ranges[w].chain = chain;
+        ranges[w].begin = count * w / workers;
+        ranges[w].end = count * (w + 1) / workers;
+        // Worker 0 runs on the calling thread, as does any worker that fails to start
+        started[w] = w > 0 && pthread_create(&tids[w], NULL, verify_range, &ranges[w]) == 0;
+    }
+    verify_range(&ranges[0]);
+    for (size_t w = 1; w < workers; w++) {
+        if (started[w]) {
+            pthread_join(tids[w], NULL);
+        } else {
+            verify_range(&ranges[w]);
+        }
+    }
+
+    static const uint8_t zero_hash[HASH_LENGTH];
+    int bad = -1;
+    for (size_t w = 0; w < workers && bad < 0; w++) {
+        const VerifyRange* range = &ranges[w];
+        if (range->begin == range->end) {
+            continue;
+        }
+        const uint8_t* expected = w > 0 ? ranges[w - 1].last_hash : zero_hash;
+        if (memcmp(chain->blocks[range->begin]->previous_hash, expected, HASH_LENGTH) != 0) {
+            bad = (int)range->begin;
+        } else if (range->first_bad != SIZE_MAX) {
+            bad = (int)range->first_bad;
+        }
+    }
+    if (ranges != &single) {
+        free(ranges);
+        free(tids);
+        free(started);
+    }
+    return bad;
+}
+
+/**
+ * @brief Verify blockchain integrity on one thread
+ * @param chain Chain handle
+ * @return 1 if valid, 0 if invalid
+ */
+int verify_blockchain(const Blockchain* chain) {
+    int bad = verify_blockchain_parallel(chain, 1);
+    if (bad >= 0) {
+        printf("WARNING: Block #%d hash mismatch!\n", bad);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Print entire blockchain
+ * @param chain Chain handle
+ */
+void print_blockchain(const Blockchain* chain) {
+    for (Block* current = chain->head; current != NULL; current = current->next) {
+        print_block(chain, current);
+    }
+    printf("\nTotal blocks in blockchain: %zu\n", chain->count);
+}
+
+/**
+ * @brief Free blockchain memory and reset the handle
+ *
+ * Blocks, transactions and account names live in the chain's arenas,
+ * so this is a few arena releases rather than a walk over every block.
+ *
+ * @param chain Chain handle
+ */
+void free_blockchain(Blockchain* chain) {
+    arena_release(&chain->block_arena);
+    arena_release(&chain->tx_arena);
+    arena_release(&chain->name_arena);
+    free(chain->accounts.names);
+    free(chain->accounts.slots);
+    free(chain->blocks);
+    free(chain->hash_slots);
+    blockchain_init(chain);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file
+ * @brief Blockchain data structures: chain handle, arenas, Merkle proofs and mining
+ *
+ * Demonstrates:
+ * - O(1) append and lookup by index or hash through a chain handle
+ * - Arena storage: blocks and transaction spans freed in one release
+ * - SHA-256 over a canonical binary header that commits to the transactions
+ * - Merkle root over the transactions with O(log n) inclusion proofs
+ * - Parallel verification: hash recomputation over index ranges, stitched at the seams
+ * - Proof of work: nonce space split across threads, eight nonces per hash pass
+ * - Struct-of-arrays transactions: interned account IDs, fixed-point amounts, time deltas
+ * - Blocks sized by a byte limit, with columns grown by doubling
+ */
+
+#ifndef BLOCKCHAIN_H
+#define BLOCKCHAIN_H
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "sha256.h"
+
+#define HASH_LENGTH SHA256_DIGEST_SIZE
+#define BLOCK_HEADER_SIZE 88
+#define MERKLE_MAX_DEPTH 32
+#define AMOUNT_SCALE 100000000LL
+#define INVALID_ACCOUNT UINT32_MAX
+#define TRANSACTION_ROW_SIZE (sizeof(int64_t) + 2 * sizeof(uint32_t) + sizeof(int32_t))
+#define DEFAULT_MAX_BLOCK_BYTES (1024 * 1024)
+
+/**
+ * @brief One transaction, decoded from a block's columns
+ *
+ * Accounts are interned IDs (see account_intern); amount is in units of
+ * 1 / AMOUNT_SCALE coin.
+ */
+typedef struct {
+    uint32_t sender;
+    uint32_t receiver;
+    int64_t amount;
+    time_t timestamp;
+} Transaction;
+
+/**
+ * @brief A block's transactions as parallel columns in one arena span
+ *
+ * time_deltas are seconds relative to the block timestamp.
+ */
+typedef struct {
+    int64_t* amounts;
+    uint32_t* senders;
+    uint32_t* receivers;
+    int32_t* time_deltas;
+} TransactionColumns;
+
+/**
+ * @brief Block structure containing transactions
+ *
+ * txs is a span in the chain's transaction arena with room for
+ * transaction_capacity rows. Hashes are
+ * raw SHA-256 digests; current_hash covers the serialized header (see
+ * serialize_block_header), which includes merkle_root. A valid
+ * current_hash has at least difficulty leading zero bits.
+ */
+typedef struct Block {
+    int index;
+    uint8_t previous_hash[HASH_LENGTH];
+    uint8_t merkle_root[HASH_LENGTH];
+    TransactionColumns txs;
+    int transaction_count;
+    int transaction_capacity;
+    time_t timestamp;
+    uint32_t difficulty;
+    uint64_t nonce;
+    uint8_t current_hash[HASH_LENGTH];
+    struct Block* next;
+} Block;
+
+/**
+ * @brief Merkle tree over a block's transactions, for serving many proofs
+ *
+ * nodes holds every level back to back, leaves first and the root last.
+ * A level with an odd count promotes its last node unchanged.
+ */
+typedef struct {
+    uint8_t (*nodes)[HASH_LENGTH];
+    size_t leaf_count;
+} MerkleTree;
+
+/**
+ * @brief Inclusion proof: sibling digests from the leaf level up
+ *
+ * Levels where the path node is promoted contribute no sibling; the
+ * verifier recovers them from leaf_index and leaf_count.
+ */
+typedef struct {
+    size_t leaf_index;
+    size_t leaf_count;
+    size_t sibling_count;
+    uint8_t siblings[MERKLE_MAX_DEPTH][HASH_LENGTH];
+} MerkleProof;
+
+/**
+ * @brief Cumulative proof-of-work counters
+ */
+typedef struct {
+    uint64_t hashes;
+    double seconds;
+    int threads;
+} MiningStats;
+
+/**
+ * @brief Arena chunk; allocations are bumped out of data
+ */
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t used;
+    size_t size;
+    alignas(max_align_t) unsigned char data[];
+} ArenaChunk;
+
+/**
+ * @brief Bump allocator over a list of chunks, released all at once
+ */
+typedef struct {
+    ArenaChunk* head;
+} Arena;
+
+/**
+ * @brief Interned account names; an account's ID is its position in names
+ *
+ * slots is an open-addressing table (linear probing, at most half full)
+ * of ID + 1, with 0 marking an empty slot.
+ */
+typedef struct {
+    const char** names;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t* slots;
+    size_t slot_capacity;
+} AccountTable;
+
+/**
+ * @brief Chain handle: list ends plus lookup indexes
+ *
+ * blocks[i] is the block with index i. hash_slots is an open-addressing
+ * table (linear probing, at most half full) of blocks keyed by
+ * current_hash. add_block mines to difficulty on mining_threads
+ * workers when difficulty is nonzero. A block's transaction rows may
+ * take at most max_block_bytes (TRANSACTION_ROW_SIZE each).
+ */
+typedef struct {
+    Block* head;
+    Block* tail;
+    Arena block_arena;
+    Arena tx_arena;
+    Arena name_arena;
+    AccountTable accounts;
+    Block** blocks;
+    size_t count;
+    size_t capacity;
+    Block** hash_slots;
+    size_t hash_capacity;
+    uint32_t difficulty;
+    int mining_threads;
+    MiningStats mining;
+    size_t max_block_bytes;
+} Blockchain;
+
+/* Arenas */
+void* arena_alloc(Arena* arena, size_t size, size_t align);
+void arena_release(Arena* arena);
+
+/* Chain handle and lookups */
+void blockchain_init(Blockchain* chain);
+int blockchain_index_block(Blockchain* chain, Block* block);
+Block* blockchain_get(const Blockchain* chain, int index);
+Block* blockchain_find_by_hash(const Blockchain* chain, const uint8_t hash[HASH_LENGTH]);
+Block* create_genesis_block(Blockchain* chain);
+Block* add_block(Blockchain* chain);
+void free_blockchain(Blockchain* chain);
+
+/* Accounts and transactions */
+uint32_t account_intern(Blockchain* chain, const char* name);
+const char* account_name(const Blockchain* chain, uint32_t id);
+void block_transaction(const Block* block, int i, Transaction* out);
+int add_transactions(Blockchain* chain, Block* block, const Transaction* txs, size_t n);
+int add_transaction(Blockchain* chain, Block* block, const char* sender, const char* receiver, int64_t amount);
+int64_t account_volume(const Blockchain* chain, uint32_t account);
+
+/* Merkle commitments */
+void transaction_leaf_hash(const Transaction* tx, uint8_t out[HASH_LENGTH]);
+void calculate_merkle_root(const Block* block, uint8_t out[HASH_LENGTH]);
+int merkle_tree_build(const Block* block, MerkleTree* tree);
+const uint8_t* merkle_tree_root(const MerkleTree* tree);
+int merkle_tree_proof(const MerkleTree* tree, size_t tx_index, MerkleProof* proof);
+void merkle_tree_free(MerkleTree* tree);
+int verify_merkle_proof(const Transaction* tx, const MerkleProof* proof, const uint8_t root[HASH_LENGTH]);
+
+/* Header hashing and proof of work */
+void hash_to_hex(const uint8_t hash[HASH_LENGTH], char out[2 * HASH_LENGTH + 1]);
+void serialize_block_header(const Block* block, const uint8_t merkle_root[HASH_LENGTH],
+                            uint8_t out[BLOCK_HEADER_SIZE]);
+int hash_meets_difficulty(const uint8_t hash[HASH_LENGTH], uint32_t difficulty);
+void calculate_block_hash(Block* block);
+void compute_block_hashes(Block* const* blocks, size_t count, uint8_t (*out)[HASH_LENGTH]);
+int mine_block(Block* block, uint32_t difficulty, int threads, MiningStats* stats);
+double mining_hashes_per_second_per_core(const MiningStats* stats);
+
+/* Verification and output */
+int verify_blockchain_parallel(const Blockchain* chain, int threads);
+int verify_blockchain(const Blockchain* chain);
+void print_block(const Blockchain* chain, const Block* block);
+void print_blockchain(const Blockchain* chain);
+
+#endif
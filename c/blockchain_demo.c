@@ -1,7 +1,9 @@
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
-#include <time.h>
+#include <unistd.h>
+
+#include "block_file.h"
+#include "blockchain.h"
 
 /**
  * @file
@@ -13,197 +15,12 @@
  * - Linked blocks
  * - Hash verification
  * - Simple transaction structure
+ * - Chain handle, Merkle proofs, parallel verification and mining (see blockchain.h)
+ * - Persistence through an append-only block file (see block_file.h)
+ *
+ * Build: gcc -O2 -pthread blockchain_demo.c blockchain.c block_file.c sha256.c -o blockchain_demo
  */
 
-#define MAX_TRANSACTIONS 10
-#define HASH_LENGTH 32
-
-/**
- * @brief Simple transaction structure
- */
-typedef struct {
-    char sender[64];
-    char receiver[64];
-    double amount;
-    time_t timestamp;
-} Transaction;
-
-/**
- * @brief Block structure containing transactions
- */
-typedef struct Block {
-    int index;
-    char previous_hash[HASH_LENGTH + 1];
-    Transaction transactions[MAX_TRANSACTIONS];
-    int transaction_count;
-    time_t timestamp;
-    char current_hash[HASH_LENGTH + 1];
-    struct Block* next;
-} Block;
-
-/**
- * @brief Calculate simple hash (simulated)
- * @param data Data to hash
- * @return Hash value (unsigned long)
- */
-unsigned long simple_hash(const char* data) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *data++)) {
-        hash = ((hash << 5) + hash) + c;
-    }
-    return hash;
-}
-
-/**
- * @brief Add transaction to block
- * @param block Pointer to block
- * @param sender Transaction sender
- * @param receiver Transaction receiver
- * @param amount Transaction amount
- */
-void add_transaction(Block* block, const char* sender, const char* receiver, double amount) {
-    if (block->transaction_count < MAX_TRANSACTIONS) {
-        Transaction* tx = &block->transactions[block->transaction_count];
-        snprintf(tx->sender, 64, "%s", sender);
-        snprintf(tx->receiver, 64, "%s", receiver);
-        tx->amount = amount;
-        tx->timestamp = time(NULL);
-        block->transaction_count++;
-        printf("Transaction added: %s -> %s (%.2f BTC)\n", sender, receiver, amount);
-    } else {
-        printf("Block full! Cannot add transaction.\n");
-    }
-}
-
-/**
- * @brief Calculate block hash
- * @param block Block to hash
- */
-void calculate_block_hash(Block* block) {
-    char hash_data[256];
-    snprintf(hash_data, sizeof(hash_data), "%d%s%ld",
-             block->index,
-             block->previous_hash,
-             block->timestamp);
-
-    snprintf(block->current_hash, HASH_LENGTH, "%lx", simple_hash(hash_data));
-}
-
-/**
- * @brief Print block details
- * @param block Block to print
- */
-void print_block(const Block* block) {
-    printf("\n=== BLOCK #%d ===\n", block->index);
-    printf("Previous Hash: %s\n", block->previous_hash);
-    printf("Current Hash: %s\n", block->current_hash);
-    printf("Timestamp: %ld\n", (long)block->timestamp);
-    printf("Transactions: %d\n", block->transaction_count);
-
-    for (int i = 0; i < block->transaction_count; i++) {
-        printf("  %s -> %s (%.2f BTC)\n",
-               block->transactions[i].sender,
-               block->transactions[i].receiver,
-               block->transactions[i].amount);
-    }
-    printf("===================\n");
-}
-
-/**
- * @brief Create genesis block
- * @param blockchain Pointer to blockchain head
- */
-void create_genesis_block(Block** blockchain) {
-    *blockchain = (Block*)malloc(sizeof(Block));
-    (*blockchain)->index = 0;
-    strcpy((*blockchain)->previous_hash, "00000000000000000000000000000000000000");
-    (*blockchain)->transaction_count = 0;
-    (*blockchain)->timestamp = time(NULL);
-    (*blockchain)->next = NULL;
-    calculate_block_hash(*blockchain);
-    printf("Genesis block created.\n");
-}
-
-/**
- * @brief Add new block to blockchain
- * @param blockchain Pointer to blockchain head
- */
-void add_block(Block** blockchain) {
-    // Find the last block
-    Block* last_block = *blockchain;
-    while (last_block->next != NULL) {
-        last_block = last_block->next;
-    }
-
-    // Create new block
-    Block* new_block = (Block*)malloc(sizeof(Block));
-    new_block->index = last_block->index + 1;
-    strcpy(new_block->previous_hash, last_block->current_hash);
-    new_block->transaction_count = 0;
-    new_block->timestamp = time(NULL);
-    new_block->next = NULL;
-    last_block->next = new_block;
-
-    // Add a sample transaction
-    add_transaction(new_block, "Alice", "Bob", 1.5);
-    add_transaction(new_block, "Charlie", "Dave", 0.75);
-
-    // Calculate hash
-    calculate_block_hash(new_block);
-
-    printf("Block #%d added to blockchain.\n", new_block->index);
-}
-
-/**
- * @brief Verify blockchain integrity
- * @param blockchain Pointer to blockchain head
- * @return 1 if valid, 0 if invalid
- */
-int verify_blockchain(Block* blockchain) {
-    Block* current = blockchain;
-    while (current != NULL) {
-        Block* next = current->next;
-        if (next != NULL) {
-            // Verify previous hash matches
-            if (strcmp(next->previous_hash, current->current_hash) != 0) {
-                printf("WARNING: Block #%d hash mismatch!\n", next->index);
-                return 0;
-            }
-        }
-        current = next;
-    }
-    return 1;
-}
-
-/**
- * @brief Print entire blockchain
- * @param blockchain Pointer to blockchain head
- */
-void print_blockchain(Block* blockchain) {
-    Block* current = blockchain;
-    int count = 0;
-    while (current != NULL) {
-        print_block(current);
-        current = current->next;
-        count++;
-    }
-    printf("\nTotal blocks in blockchain: %d\n", count);
-}
-
-/**
- * @brief Free blockchain memory
- * @param blockchain Pointer to blockchain head
- */
-void free_blockchain(Block* blockchain) {
-    Block* current = blockchain;
-    while (current != NULL) {
-        Block* next = current->next;
-        free(current);
-        current = next;
-    }
-}
-
 /**
  * @brief Main function
  */
@@ -212,29 +29,83 @@ int main() {
     printf("Author: PARTH\n");
     printf("Date: 2026-02-10\n\n");
 
-    Block* blockchain = NULL;
+    Blockchain blockchain;
+    blockchain_init(&blockchain);
 
     // Create genesis block
-    create_genesis_block(&blockchain);
+    if (create_genesis_block(&blockchain) == NULL) {
+        return 1;
+    }
 
-    // Add some blocks with transactions
+    // Add some blocks with transactions, mined on every core
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    blockchain.difficulty = 16;
+    blockchain.mining_threads = cpus > 0 ? (int)cpus : 1;
     add_block(&blockchain);
     add_block(&blockchain);
     add_block(&blockchain);
+    printf("Mined at %.0f hashes/sec per core on %d threads\n",
+           mining_hashes_per_second_per_core(&blockchain.mining), blockchain.mining.threads);
 
     // Print blockchain
-    print_blockchain(blockchain);
+    print_blockchain(&blockchain);
+
+    // Look blocks up through the indexes
+    Block* second = blockchain_get(&blockchain, 2);
+    if (second != NULL && blockchain_find_by_hash(&blockchain, second->current_hash) == second) {
+        printf("\nBlock #2 found by index and by hash.\n");
+    }
+
+    // Prove one transaction's inclusion against the header alone
+    MerkleTree tree;
+    MerkleProof proof;
+    if (second != NULL && merkle_tree_build(second, &tree)) {
+        Transaction tx;
+        block_transaction(second, 1, &tx);
+        if (merkle_tree_proof(&tree, 1, &proof) && verify_merkle_proof(&tx, &proof, second->merkle_root)) {
+            printf("Transaction 1 of block #2 proven with %zu sibling hashes.\n", proof.sibling_count);
+        }
+        merkle_tree_free(&tree);
+    }
+    printf("SHA-256 kernel: %s, 8-way: %s\n", sha256_backend(), sha256_x8_backend());
+    int64_t volume = account_volume(&blockchain, account_intern(&blockchain, "Alice"));
+    printf("Alice volume: %lld.%08lld BTC\n", (long long)(volume / AMOUNT_SCALE), (long long)(volume % AMOUNT_SCALE));
 
     // Verify integrity
     printf("\nVerifying blockchain integrity...\n");
-    if (verify_blockchain(&blockchain)) {
+    int bad = verify_blockchain_parallel(&blockchain, cpus > 0 ? (int)cpus : 1);
+    if (bad < 0) {
         printf("Blockchain is valid!\n");
     } else {
-        printf("Blockchain verification failed!\n");
+        printf("Blockchain verification failed at block #%d!\n", bad);
+    }
+
+    // Persist the chain, then reload it the way a restarted node would
+    BlockFileWriter writer;
+    remove("blocks.dat");
+    remove("blocks.idx");
+    if (block_file_writer_open(&writer, "blocks.dat", "blocks.idx")) {
+        for (Block* current = blockchain.head; current != NULL; current = current->next) {
+            block_file_append(&writer, &blockchain, current);
+        }
+        block_file_writer_close(&writer);
+    }
+    BlockFileReader reader;
+    Blockchain reloaded;
+    blockchain_init(&reloaded);
+    if (block_file_reader_open(&reader, "blocks.dat", "blocks.idx")) {
+        if (block_file_load(&reader, &reloaded) && verify_blockchain_parallel(&reloaded, 1) < 0 &&
+            memcmp(reloaded.tail->current_hash, blockchain.tail->current_hash, HASH_LENGTH) == 0) {
+            printf("Reloaded %zu blocks from blocks.dat (%zu indexed).\n", reloaded.count, reader.count);
+        }
+        block_file_reader_close(&reader);
     }
+    free_blockchain(&reloaded);
+    remove("blocks.dat");
+    remove("blocks.idx");
 
     // Free memory
-    free_blockchain(blockchain);
+    free_blockchain(&blockchain);
 
     printf("\n=== Implementation Complete ===\n");
 
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Bounded lock-free pointer queues: single-producer and multi-producer rings
+ *
+ * Demonstrates:
+ * - SPSC ring with acquire/release head and tail on separate cache lines
+ * - MPSC ring with per-slot sequence numbers (Vyukov's bounded queue)
+ * - Depth and high-water tracking for pipeline metrics
+ *
+ * Capacities are powers of two. Push returns 0 when the ring is full and
+ * pop returns NULL when it is empty, so NULL cannot be queued.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define QUEUE_CACHE_LINE 64
+
+/**
+ * @brief One producer thread, one consumer thread
+ */
+typedef struct {
+    alignas(QUEUE_CACHE_LINE) atomic_size_t head;
+    alignas(QUEUE_CACHE_LINE) atomic_size_t tail;
+    atomic_size_t high_water;
+    alignas(QUEUE_CACHE_LINE) size_t mask;
+    void** slots;
+} SpscQueue;
+
+static inline int spsc_init(SpscQueue* q, size_t capacity) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->high_water, 0);
+    q->mask = capacity - 1;
+    q->slots = (void**)calloc(capacity, sizeof(void*));
+    return q->slots != NULL && (capacity & (capacity - 1)) == 0;
+}
+
+static inline void spsc_destroy(SpscQueue* q) {
+    free(q->slots);
+    q->slots = NULL;
+}
+
+static inline int spsc_push(SpscQueue* q, void* item) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (tail - head > q->mask) {
+        return 0;
+    }
+    q->slots[tail & q->mask] = item;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    if (tail + 1 - head > atomic_load_explicit(&q->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&q->high_water, tail + 1 - head, memory_order_relaxed);
+    }
+    return 1;
+}
+
+static inline void* spsc_pop(SpscQueue* q) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&q->tail, memory_order_acquire)) {
+        return NULL;
+    }
+    void* item = q->slots[head & q->mask];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return item;
+}
+
+static inline size_t spsc_depth(SpscQueue* q) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    return atomic_load_explicit(&q->tail, memory_order_relaxed) - head;
+}
+
+/**
+ * @brief Ring slot: seq == position when free, position + 1 once filled
+ */
+typedef struct {
+    atomic_size_t seq;
+    void* item;
+} MpscSlot;
+
+/**
+ * @brief Any number of producer threads, one consumer thread
+ */
+typedef struct {
+    alignas(QUEUE_CACHE_LINE) atomic_size_t head;
+    alignas(QUEUE_CACHE_LINE) atomic_size_t tail;
+    atomic_size_t high_water;
+    alignas(QUEUE_CACHE_LINE) size_t mask;
+    MpscSlot* slots;
+} MpscQueue;
+
+static inline int mpsc_init(MpscQueue* q, size_t capacity) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->high_water, 0);
+    q->mask = capacity - 1;
+    q->slots = (MpscSlot*)calloc(capacity, sizeof(MpscSlot));
+    if (q->slots == NULL || (capacity & (capacity - 1)) != 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&q->slots[i].seq, i);
+    }
+    return 1;
+}
+
+static inline void mpsc_destroy(MpscQueue* q) {
+    free(q->slots);
+    q->slots = NULL;
+}
+
+static inline int mpsc_push(MpscQueue* q, void* item) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    for (;;) {
+        MpscSlot* slot = &q->slots[pos & q->mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->item = item;
+                atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+    size_t depth = pos + 1 - atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t seen = atomic_load_explicit(&q->high_water, memory_order_relaxed);
+    while (depth > seen && !atomic_compare_exchange_weak_explicit(&q->high_water, &seen, depth, memory_order_relaxed,
+                                                                  memory_order_relaxed)) {
+    }
+    return 1;
+}
+
+static inline void* mpsc_pop(MpscQueue* q) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    MpscSlot* slot = &q->slots[head & q->mask];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1) {
+        return NULL;
+    }
+    void* item = slot->item;
+    atomic_store_explicit(&slot->seq, head + q->mask + 1, memory_order_release);
+    atomic_store_explicit(&q->head, head + 1, memory_order_relaxed);
+    return item;
+}
+
+static inline size_t mpsc_depth(MpscQueue* q) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+#endif
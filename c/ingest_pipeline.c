@@ -0,0 +1,754 @@
+/**
+ * @file
+ * @brief Staged block ingest pipeline (see ingest_pipeline.h)
+ *
+ * Build: gcc -O2 -pthread -DINGEST_PIPELINE_MAIN ingest_pipeline.c socket_client.c block_file.c blockchain.c sha256.c
+ *        -o ingest_pipeline
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ingest_pipeline.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "block_file.h"
+
+#define BACKOFF_YIELDS 64
+#define BACKOFF_SLEEP_NS 50000
+
+/** Pushed through every queue by ingest_pipeline_finish */
+static char stop_marker;
+#define STOP ((void*)&stop_marker)
+
+struct IngestWorker {
+    IngestPipeline* pipeline;
+    SpscQueue queue;
+    pthread_t thread;
+};
+
+/**
+ * @brief A received block travelling from receive to apply
+ *
+ * view's pointers alias the frame, which this item holds until
+ * free_item, or the item's own copy once detach_item has run; hash is
+ * filled in by the verify stage.
+ */
+struct IngestItem {
+    PeerClient* client;
+    PeerFrame frame;
+    uint8_t* copy;
+    BlockView view;
+    uint8_t hash[HASH_LENGTH];
+    int valid;
+    IngestItem* next;
+};
+
+/**
+ * @brief Wait for a queue to change: yield first, then sleep briefly
+ */
+static void backoff(unsigned* spins) {
+    if (*spins < BACKOFF_YIELDS) {
+        sched_yield();
+    } else {
+        struct timespec ts = {0, BACKOFF_SLEEP_NS};
+        nanosleep(&ts, NULL);
+    }
+    (*spins)++;
+}
+
+static void spsc_push_wait(SpscQueue* q, void* item) {
+    unsigned spins = 0;
+    while (!spsc_push(q, item)) {
+        backoff(&spins);
+    }
+}
+
+static void* spsc_pop_wait(SpscQueue* q) {
+    unsigned spins = 0;
+    void* item;
+    while ((item = spsc_pop(q)) == NULL) {
+        backoff(&spins);
+    }
+    return item;
+}
+
+static void mpsc_push_wait(MpscQueue* q, void* item) {
+    unsigned spins = 0;
+    while (!mpsc_push(q, item)) {
+        backoff(&spins);
+    }
+}
+
+static void* mpsc_pop_wait(MpscQueue* q) {
+    unsigned spins = 0;
+    void* item;
+    while ((item = mpsc_pop(q)) == NULL) {
+        backoff(&spins);
+    }
+    return item;
+}
+
+/**
+ * @brief Give the item's frame back to its peer (from any stage's thread)
+ */
+static void free_item(IngestItem* item) {
+    if (item->copy != NULL) {
+        free(item->copy);
+    } else {
+        peer_frame_release(item->client, &item->frame);
+    }
+    free(item);
+}
+
+/**
+ * @brief Move a parked block out of its receive chunk and release the frame
+ *
+ * A block waiting for a predecessor may be waiting for bytes its peer
+ * has not sent yet, so it must not count against that peer's limit.
+ * Keeps holding the frame if the copy cannot be allocated.
+ */
+static void detach_item(IngestItem* item) {
+    size_t size = ((size_t)item->frame.length + 7) & ~(size_t)7;
+    uint8_t* copy = (uint8_t*)aligned_alloc(8, size ? size : 8);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, item->frame.data, item->frame.length);
+    block_record_parse(copy, item->frame.length, &item->view);
+    peer_frame_release(item->client, &item->frame);
+    item->copy = copy;
+}
+
+/**
+ * @brief Move backlogged frames into the decode queue without waiting
+ * @param pipeline Pipeline
+ * @return Frames still in the backlog
+ */
+size_t ingest_pipeline_pump(IngestPipeline* pipeline) {
+    while (pipeline->backlog_head != NULL) {
+        IngestItem* item = pipeline->backlog_head;
+        IngestItem* next = item->next;
+        if (!spsc_push(&pipeline->decode_queue, item)) {
+            break;
+        }
+        // The decode thread owns item from here on
+        pipeline->backlog_head = next;
+        atomic_fetch_sub_explicit(&pipeline->backlog, 1, memory_order_relaxed);
+    }
+    if (pipeline->backlog_head == NULL) {
+        pipeline->backlog_tail = NULL;
+    }
+    return atomic_load_explicit(&pipeline->backlog, memory_order_relaxed);
+}
+
+/**
+ * @brief Receive stage: runs on the peer client's loop thread
+ *
+ * Frames are handed on without copying and never wait for the decode
+ * queue: a full queue leaves them in the backlog, still charged to their
+ * peer, so a slow pipeline pauses reading instead of stalling the loop.
+ * Under memory pressure the frame is released and counted as rejected.
+ */
+void ingest_pipeline_on_frame(PeerClient* client, const PeerFrame* frame, void* user) {
+    IngestPipeline* pipeline = (IngestPipeline*)user;
+    IngestItem* item = (IngestItem*)malloc(sizeof(IngestItem));
+    atomic_fetch_add_explicit(&pipeline->received, 1, memory_order_relaxed);
+    if (item == NULL) {
+        peer_frame_release(client, frame);
+        atomic_fetch_add_explicit(&pipeline->rejected, 1, memory_order_relaxed);
+        return;
+    }
+    item->client = client;
+    item->frame = *frame;
+    item->copy = NULL;
+    item->valid = 0;
+    item->next = NULL;
+    if (pipeline->backlog_tail != NULL) {
+        pipeline->backlog_tail->next = item;
+    } else {
+        pipeline->backlog_head = item;
+    }
+    pipeline->backlog_tail = item;
+    atomic_fetch_add_explicit(&pipeline->backlog, 1, memory_order_relaxed);
+    ingest_pipeline_pump(pipeline);
+}
+
+/**
+ * @brief Decode stage: parse each record in place in its receive chunk
+ *
+ * The peer client keeps payloads 8-byte aligned, so the column arrays
+ * are used where they arrived.
+ */
+static void* decode_main(void* arg) {
+    IngestPipeline* pipeline = (IngestPipeline*)arg;
+    int next = 0;
+    for (;;) {
+        IngestItem* item = (IngestItem*)spsc_pop_wait(&pipeline->decode_queue);
+        if (item == (IngestItem*)STOP) {
+            break;
+        }
+        if (!block_record_parse(item->frame.data, item->frame.length, &item->view)) {
+            free_item(item);
+            atomic_fetch_add_explicit(&pipeline->rejected, 1, memory_order_relaxed);
+            continue;
+        }
+        atomic_fetch_add_explicit(&pipeline->decoded, 1, memory_order_relaxed);
+
+        // Round-robin, skipping workers whose queue is full
+        unsigned spins = 0;
+        for (;;) {
+            int k = 0;
+            while (k < pipeline->worker_count && !spsc_push(&pipeline->workers[next].queue, item)) {
+                next = (next + 1) % pipeline->worker_count;
+                k++;
+            }
+            if (k < pipeline->worker_count) {
+                break;
+            }
+            backoff(&spins);
+        }
+        next = (next + 1) % pipeline->worker_count;
+    }
+    for (int w = 0; w < pipeline->worker_count; w++) {
+        spsc_push_wait(&pipeline->workers[w].queue, STOP);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Verify stage: recompute the Merkle root and header hash and check the work
+ *
+ * The scratch Block borrows the record's columns read-only.
+ */
+static void* verify_main(void* arg) {
+    IngestWorker* worker = (IngestWorker*)arg;
+    IngestPipeline* pipeline = worker->pipeline;
+    for (;;) {
+        IngestItem* item = (IngestItem*)spsc_pop_wait(&worker->queue);
+        if (item == (IngestItem*)STOP) {
+            break;
+        }
+        const BlockView* view = &item->view;
+        Block block;
+        memset(&block, 0, sizeof(block));
+        block.index = view->index;
+        memcpy(block.previous_hash, view->previous_hash, HASH_LENGTH);
+        block.txs.amounts = (int64_t*)view->amounts;
+        block.txs.senders = (uint32_t*)view->senders;
+        block.txs.receivers = (uint32_t*)view->receivers;
+        block.txs.time_deltas = (int32_t*)view->time_deltas;
+        block.transaction_count = (int)view->transaction_count;
+        block.timestamp = view->timestamp;
+        block.difficulty = view->difficulty;
+        block.nonce = view->nonce;
+        calculate_block_hash(&block);
+
+        item->valid = view->index >= 0 && view->transaction_count <= INT32_MAX &&
+                      memcmp(block.merkle_root, view->merkle_root, HASH_LENGTH) == 0 &&
+                      hash_meets_difficulty(block.current_hash, view->difficulty);
+        memcpy(item->hash, block.current_hash, HASH_LENGTH);
+        if (item->valid) {
+            atomic_fetch_add_explicit(&pipeline->verified, 1, memory_order_relaxed);
+        }
+        mpsc_push_wait(&pipeline->apply_queue, item);
+    }
+    mpsc_push_wait(&pipeline->apply_queue, STOP);
+    return NULL;
+}
+
+/**
+ * @brief Min-heap of verified blocks waiting for their predecessors
+ */
+typedef struct {
+    IngestItem** items;
+    size_t count;
+    size_t capacity;
+} ReorderHeap;
+
+static int heap_push(ReorderHeap* heap, IngestItem* item) {
+    if (heap->count == heap->capacity) {
+        size_t capacity = heap->capacity ? heap->capacity * 2 : 64;
+        IngestItem** items = (IngestItem**)realloc(heap->items, capacity * sizeof(IngestItem*));
+        if (items == NULL) {
+            return 0;
+        }
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    size_t i = heap->count++;
+    while (i > 0 && heap->items[(i - 1) / 2]->view.index > item->view.index) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = item;
+    return 1;
+}
+
+static IngestItem* heap_pop(ReorderHeap* heap) {
+    IngestItem* top = heap->items[0];
+    IngestItem* last = heap->items[--heap->count];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && heap->items[child + 1]->view.index < heap->items[child]->view.index) {
+            child++;
+        }
+        if (heap->items[child]->view.index >= last->view.index) {
+            break;
+        }
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) {
+        heap->items[i] = last;
+    }
+    return top;
+}
+
+static void reject(IngestPipeline* pipeline, IngestItem* item) {
+    if (pipeline->first_rejected < 0) {
+        pipeline->first_rejected = item->view.index;
+    }
+    atomic_fetch_add_explicit(&pipeline->rejected, 1, memory_order_relaxed);
+    free_item(item);
+}
+
+/**
+ * @brief Append the next block in order if it links to the current tip
+ */
+static void apply_item(IngestPipeline* pipeline, IngestItem* item) {
+    static const uint8_t zero[HASH_LENGTH];
+    Blockchain* chain = pipeline->config.chain;
+    const uint8_t* tip = chain->tail != NULL ? chain->tail->current_hash : zero;
+    Block* block = NULL;
+    if (item->view.difficulty >= chain->difficulty && memcmp(item->view.previous_hash, tip, HASH_LENGTH) == 0) {
+        block = block_file_import(chain, &item->view, item->hash);
+    }
+    if (block == NULL) {
+        reject(pipeline, item);
+        return;
+    }
+    if (pipeline->config.on_block != NULL) {
+        pipeline->config.on_block(chain, block, pipeline->config.user);
+    }
+    atomic_fetch_add_explicit(&pipeline->applied, 1, memory_order_relaxed);
+    free_item(item);
+}
+
+/**
+ * @brief Apply stage: put verified blocks back in index order and extend the chain
+ *
+ * Verification finishes out of order across workers, so blocks wait in
+ * a heap until the chain reaches their index. A rejected block leaves
+ * its index open for a later copy (from another peer, say); blocks too
+ * far ahead of the tip are dropped to keep the heap bounded. Blocks that
+ * are not applied at once are detached from their frames.
+ */
+static void* apply_main(void* arg) {
+    IngestPipeline* pipeline = (IngestPipeline*)arg;
+    Blockchain* chain = pipeline->config.chain;
+    size_t window = pipeline->config.queue_capacity * (size_t)(pipeline->worker_count + 2);
+    ReorderHeap heap = {NULL, 0, 0};
+    int stops = 0;
+    while (stops < pipeline->worker_count) {
+        IngestItem* item = (IngestItem*)mpsc_pop_wait(&pipeline->apply_queue);
+        if (item == (IngestItem*)STOP) {
+            stops++;
+            continue;
+        }
+        if (!item->valid) {
+            reject(pipeline, item);
+            continue;
+        }
+        if ((size_t)item->view.index < chain->count) {
+            atomic_fetch_add_explicit(&pipeline->duplicates, 1, memory_order_relaxed);
+            free_item(item);
+            continue;
+        }
+        if ((size_t)item->view.index - chain->count >= window) {
+            reject(pipeline, item);
+            continue;
+        }
+        if ((size_t)item->view.index > chain->count) {
+            detach_item(item);
+        }
+        if (!heap_push(&heap, item)) {
+            reject(pipeline, item);
+            continue;
+        }
+        while (heap.count > 0 && (size_t)heap.items[0]->view.index <= chain->count) {
+            IngestItem* ready = heap_pop(&heap);
+            if ((size_t)ready->view.index < chain->count) {
+                atomic_fetch_add_explicit(&pipeline->duplicates, 1, memory_order_relaxed);
+                free_item(ready);
+            } else {
+                apply_item(pipeline, ready);
+            }
+        }
+        atomic_store_explicit(&pipeline->reorder_depth, heap.count, memory_order_relaxed);
+    }
+    // Whatever is still waiting never got its predecessor
+    while (heap.count > 0) {
+        reject(pipeline, heap_pop(&heap));
+    }
+    atomic_store_explicit(&pipeline->reorder_depth, 0, memory_order_relaxed);
+    free(heap.items);
+    return NULL;
+}
+
+/**
+ * @brief Send the stop marker to the first count verify workers and join them
+ */
+static void stop_workers(IngestPipeline* pipeline, int count) {
+    for (int w = 0; w < count; w++) {
+        spsc_push_wait(&pipeline->workers[w].queue, STOP);
+    }
+    for (int w = 0; w < count; w++) {
+        pthread_join(pipeline->workers[w].thread, NULL);
+    }
+}
+
+static void destroy_queues(IngestPipeline* pipeline) {
+    spsc_destroy(&pipeline->decode_queue);
+    if (pipeline->workers != NULL) {
+        for (int w = 0; w < pipeline->worker_count; w++) {
+            spsc_destroy(&pipeline->workers[w].queue);
+        }
+    }
+    mpsc_destroy(&pipeline->apply_queue);
+    free(pipeline->workers);
+    pipeline->workers = NULL;
+}
+
+/**
+ * @brief Start the decode, verify and apply threads
+ * @param pipeline Pipeline to start
+ * @param config Stage sizes (queue_capacity is rounded up to a power of two),
+ *        the target chain (empty, or a prefix of the incoming blocks) and the optional on_block hook
+ * @return 1 on success, 0 if a queue or thread could not be created
+ */
+int ingest_pipeline_start(IngestPipeline* pipeline, const IngestConfig* config) {
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->config = *config;
+    if (pipeline->config.verify_threads <= 0) {
+        pipeline->config.verify_threads = 1;
+    }
+    size_t capacity = 1;
+    while (capacity < (pipeline->config.queue_capacity ? pipeline->config.queue_capacity : INGEST_DEFAULT_QUEUE)) {
+        capacity *= 2;
+    }
+    pipeline->config.queue_capacity = capacity;
+    pipeline->first_rejected = -1;
+    atomic_init(&pipeline->backlog, 0);
+    atomic_init(&pipeline->reorder_depth, 0);
+    atomic_init(&pipeline->received, 0);
+    atomic_init(&pipeline->decoded, 0);
+    atomic_init(&pipeline->verified, 0);
+    atomic_init(&pipeline->applied, 0);
+    atomic_init(&pipeline->rejected, 0);
+    atomic_init(&pipeline->duplicates, 0);
+
+    int threads = pipeline->config.verify_threads;
+    pipeline->workers = (IngestWorker*)calloc((size_t)threads, sizeof(IngestWorker));
+    int ok = pipeline->workers != NULL && config->chain != NULL;
+    ok = spsc_init(&pipeline->decode_queue, capacity) && ok;
+    ok = mpsc_init(&pipeline->apply_queue, capacity) && ok;
+    for (int w = 0; ok && w < threads; w++) {
+        pipeline->workers[w].pipeline = pipeline;
+        ok = spsc_init(&pipeline->workers[w].queue, capacity);
+        pipeline->worker_count = w + 1;
+    }
+    if (!ok) {
+        destroy_queues(pipeline);
+        return 0;
+    }
+
+    // Apply first, so it is there to drain the STOPs of however many workers start
+    if (pthread_create(&pipeline->apply_thread, NULL, apply_main, pipeline) != 0) {
+        destroy_queues(pipeline);
+        return 0;
+    }
+    int started = 0;
+    while (started < threads &&
+           pthread_create(&pipeline->workers[started].thread, NULL, verify_main, &pipeline->workers[started]) == 0) {
+        started++;
+    }
+    if (started == threads && pthread_create(&pipeline->decode_thread, NULL, decode_main, pipeline) == 0) {
+        return 1;
+    }
+    stop_workers(pipeline, started);
+    // apply waits for one STOP per worker; stand in for those never started
+    for (int w = started; w < threads; w++) {
+        mpsc_push_wait(&pipeline->apply_queue, STOP);
+    }
+    pthread_join(pipeline->apply_thread, NULL);
+    destroy_queues(pipeline);
+    return 0;
+}
+
+/**
+ * @brief Drain every stage, join the threads and free the queues
+ *
+ * The backlog is flushed first, then the stop marker follows the last
+ * frame through decode, every verify worker and apply, so all queued
+ * blocks are handled first. Call from the thread that delivers frames,
+ * after the last one.
+ *
+ * @return Index of the first block rejected by verify or apply, or -1;
+ *         frames that fail to decode are only counted in the stats
+ */
+int ingest_pipeline_finish(IngestPipeline* pipeline) {
+    unsigned spins = 0;
+    while (ingest_pipeline_pump(pipeline) > 0) {
+        backoff(&spins);
+    }
+    spsc_push_wait(&pipeline->decode_queue, STOP);
+    pthread_join(pipeline->decode_thread, NULL);
+    for (int w = 0; w < pipeline->worker_count; w++) {
+        pthread_join(pipeline->workers[w].thread, NULL);
+    }
+    pthread_join(pipeline->apply_thread, NULL);
+    destroy_queues(pipeline);
+    return pipeline->first_rejected;
+}
+
+/**
+ * @brief Read the counters and queue depths; safe while the pipeline runs
+ */
+void ingest_pipeline_stats(IngestPipeline* pipeline, IngestStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->decode.depth = spsc_depth(&pipeline->decode_queue);
+    stats->decode.high_water = atomic_load_explicit(&pipeline->decode_queue.high_water, memory_order_relaxed);
+    stats->decode.capacity = pipeline->config.queue_capacity;
+    for (int w = 0; pipeline->workers != NULL && w < pipeline->worker_count; w++) {
+        SpscQueue* q = &pipeline->workers[w].queue;
+        stats->verify.depth += spsc_depth(q);
+        stats->verify.high_water += atomic_load_explicit(&q->high_water, memory_order_relaxed);
+        stats->verify.capacity += pipeline->config.queue_capacity;
+    }
+    stats->apply.depth = mpsc_depth(&pipeline->apply_queue);
+    stats->apply.high_water = atomic_load_explicit(&pipeline->apply_queue.high_water, memory_order_relaxed);
+    stats->apply.capacity = pipeline->config.queue_capacity;
+    stats->receive_backlog = atomic_load_explicit(&pipeline->backlog, memory_order_relaxed);
+    stats->reorder_depth = atomic_load_explicit(&pipeline->reorder_depth, memory_order_relaxed);
+    stats->received = atomic_load_explicit(&pipeline->received, memory_order_relaxed);
+    stats->decoded = atomic_load_explicit(&pipeline->decoded, memory_order_relaxed);
+    stats->verified = atomic_load_explicit(&pipeline->verified, memory_order_relaxed);
+    stats->applied = atomic_load_explicit(&pipeline->applied, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&pipeline->rejected, memory_order_relaxed);
+    stats->duplicates = atomic_load_explicit(&pipeline->duplicates, memory_order_relaxed);
+}
+
+#ifdef INGEST_PIPELINE_MAIN
+
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define DEMO_BLOCKS 200
+#define DEMO_ROWS 64
+#define DEMO_ACCOUNTS 8
+#define DEMO_DIFFICULTY 12
+#define DEMO_TAMPERED 50
+#define DEMO_DUPLICATE 10
+
+typedef struct {
+    uint8_t** records;
+    size_t* sizes;
+    int fd;
+} DemoSender;
+
+typedef struct {
+    IngestPipeline* pipeline;
+    int closed;
+    size_t transactions;
+} DemoState;
+
+/**
+ * @brief Mine a block of random transfers onto the source chain
+ */
+static Block* demo_block(Blockchain* chain, const uint32_t* accounts) {
+    Block* block = (Block*)arena_alloc(&chain->block_arena, sizeof(Block), alignof(Block));
+    if (block == NULL) {
+        return NULL;
+    }
+    memset(block, 0, sizeof(*block));
+    block->index = chain->tail->index + 1;
+    memcpy(block->previous_hash, chain->tail->current_hash, HASH_LENGTH);
+    block->timestamp = time(NULL);
+    Transaction txs[DEMO_ROWS];
+    for (int i = 0; i < DEMO_ROWS; i++) {
+        txs[i].sender = accounts[rand() % DEMO_ACCOUNTS];
+        txs[i].receiver = accounts[rand() % DEMO_ACCOUNTS];
+        txs[i].amount = (int64_t)(rand() % 1000 + 1) * AMOUNT_SCALE / 100;
+        txs[i].timestamp = block->timestamp + i;
+    }
+    if (!add_transactions(chain, block, txs, DEMO_ROWS) || !mine_block(block, DEMO_DIFFICULTY, 1, &chain->mining) ||
+        !blockchain_index_block(chain, block)) {
+        return NULL;
+    }
+    return block;
+}
+
+/**
+ * @brief Write one frame; records are already a multiple of 8 bytes, so no padding follows
+ */
+static int write_frame(int fd, const uint8_t* record, size_t size) {
+    uint8_t prefix[PEER_FRAME_HEADER] = {size & 0xff, (size >> 8) & 0xff, (size >> 16) & 0xff, size >> 24};
+    if (write(fd, prefix, sizeof(prefix)) != (ssize_t)sizeof(prefix)) {
+        return 0;
+    }
+    for (size_t done = 0; done < size;) {
+        ssize_t n = write(fd, record + done, size - done);
+        if (n <= 0) {
+            return 0;
+        }
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+/**
+ * @brief Peer side: every block in order, plus a tampered copy and a resend
+ */
+static void* demo_send(void* arg) {
+    DemoSender* sender = (DemoSender*)arg;
+    for (int i = 0; i < DEMO_BLOCKS; i++) {
+        if (i == DEMO_TAMPERED) {
+            uint8_t* copy = (uint8_t*)malloc(sender->sizes[i]);
+            memcpy(copy, sender->records[i], sender->sizes[i]);
+            copy[8 + BLOCK_HEADER_SIZE + 8] ^= 1;  // low byte of the first amount
+            write_frame(sender->fd, copy, sender->sizes[i]);
+            free(copy);
+        }
+        write_frame(sender->fd, sender->records[i], sender->sizes[i]);
+        if (i == 2 * DEMO_DUPLICATE) {
+            write_frame(sender->fd, sender->records[DEMO_DUPLICATE], sender->sizes[DEMO_DUPLICATE]);
+        }
+    }
+    close(sender->fd);
+    return NULL;
+}
+
+static void demo_frame(PeerClient* client, const PeerFrame* frame, void* user) {
+    ingest_pipeline_on_frame(client, frame, ((DemoState*)user)->pipeline);
+}
+
+static void demo_close(PeerClient* client, int peer, void* user) {
+    (void)client;
+    (void)peer;
+    ((DemoState*)user)->closed = 1;
+}
+
+static void demo_count(Blockchain* chain, const Block* block, void* user) {
+    (void)chain;
+    ((DemoState*)user)->transactions += (size_t)block->transaction_count;
+}
+
+static void print_queue(const char* name, const IngestQueueStats* q) {
+    printf("  %-7s depth %zu, high water %zu of %zu\n", name, q->depth, q->high_water, q->capacity);
+}
+
+/**
+ * @brief Mine a chain, stream it over a socketpair and rebuild it through the pipeline
+ */
+int main() {
+    printf("=== Pipelined block ingest ===\n\n");
+
+    Blockchain source;
+    blockchain_init(&source);
+    create_genesis_block(&source);
+    uint32_t accounts[DEMO_ACCOUNTS];
+    const char* names[DEMO_ACCOUNTS] = {"Alice", "Bob", "Charlie", "Dave", "Erin", "Frank", "Grace", "Heidi"};
+    for (int i = 0; i < DEMO_ACCOUNTS; i++) {
+        accounts[i] = account_intern(&source, names[i]);
+    }
+    srand(7);
+    for (int i = 1; i < DEMO_BLOCKS; i++) {
+        if (demo_block(&source, accounts) == NULL) {
+            return 1;
+        }
+    }
+
+    // Genesis carries every account name, so each later record has none
+    static uint8_t* records[DEMO_BLOCKS];
+    static size_t sizes[DEMO_BLOCKS];
+    for (int i = 0; i < DEMO_BLOCKS; i++) {
+        const Block* block = blockchain_get(&source, i);
+        uint32_t first = i == 0 ? 0 : source.accounts.count;
+        sizes[i] = block_record_encode(&source, block, first, NULL, 0);
+        records[i] = (uint8_t*)malloc(sizes[i]);
+        if (records[i] == NULL || block_record_encode(&source, block, first, records[i], sizes[i]) != sizes[i]) {
+            return 1;
+        }
+    }
+    printf("Source chain: %zu blocks of %d transactions at difficulty %d\n", source.count, DEMO_ROWS,
+           DEMO_DIFFICULTY);
+
+    Blockchain target;
+    blockchain_init(&target);
+    IngestPipeline pipeline;
+    DemoState state = {&pipeline, 0, 0};
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    IngestConfig config = {.verify_threads = cpus > 1 ? (int)cpus : 1,
+                           .queue_capacity = 32,
+                           .chain = &target,
+                           .on_block = demo_count,
+                           .user = &state};
+    // A small in-flight limit, so the peer is paused whenever apply falls behind
+    PeerClientConfig peer_config = {
+        .max_inflight = 64 * 1024, .on_frame = demo_frame, .on_close = demo_close, .user = &state};
+    PeerClient client;
+    int fds[2];
+    if (!ingest_pipeline_start(&pipeline, &config) || !peer_client_init(&client, &peer_config) ||
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0 || peer_client_add_fd(&client, fds[0]) < 0) {
+        return 1;
+    }
+
+    DemoSender sender = {records, sizes, fds[1]};
+    pthread_t thread;
+    pthread_create(&thread, NULL, demo_send, &sender);
+    while (!state.closed) {
+        peer_client_poll(&client, ingest_pipeline_pump(&pipeline) > 0 ? 1 : 100);
+    }
+    pthread_join(thread, NULL);
+
+    IngestStats stats;
+    ingest_pipeline_stats(&pipeline, &stats);
+    printf("Queues while draining (%d verify threads, %zu frames backlogged):\n", pipeline.worker_count,
+           stats.receive_backlog);
+    print_queue("decode", &stats.decode);
+    print_queue("verify", &stats.verify);
+    print_queue("apply", &stats.apply);
+    int first_rejected = ingest_pipeline_finish(&pipeline);
+    ingest_pipeline_stats(&pipeline, &stats);
+    printf("Peer paused %llu times at %zu bytes in flight\n", (unsigned long long)client.peers[0]->pauses,
+           client.config.max_inflight);
+    printf("Received %zu, decoded %zu, verified %zu, applied %zu, rejected %zu (first at %d), duplicates %zu\n",
+           stats.received, stats.decoded, stats.verified, stats.applied, stats.rejected, first_rejected,
+           stats.duplicates);
+
+    int match = target.count == source.count &&
+                memcmp(target.tail->current_hash, source.tail->current_hash, HASH_LENGTH) == 0 &&
+                verify_blockchain(&target);
+    printf("Rebuilt %zu blocks, %zu transactions; tip %s the source\n", target.count, state.transactions,
+           match ? "matches" : "DIFFERS from");
+
+    peer_client_destroy(&client);
+    for (int i = 0; i < DEMO_BLOCKS; i++) {
+        free(records[i]);
+    }
+    free_blockchain(&target);
+    free_blockchain(&source);
+    printf("\nImplementation complete!\n");
+    return match ? 0 : 1;
+}
+
+#endif
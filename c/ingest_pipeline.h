@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Staged block ingest: receive -> decode -> verify -> apply
+ *
+ * Demonstrates:
+ * - One thread per stage, joined by bounded lock-free queues
+ * - Receive on the peer client's loop thread (ingest_pipeline_on_frame), never blocking it
+ * - Decode on one thread: records parsed in place in the peer's receive chunk
+ * - Verify on N threads: Merkle root, block hash and proof of work recomputed
+ * - Apply on one thread: blocks reordered by index and appended to the chain in order
+ * - Backpressure: a frame is held until its block is applied or dropped, so a
+ *   lagging apply stage pauses the peers that feed it
+ * - Per-queue depth and high-water metrics
+ *
+ * Each frame is one block record as produced by block_record_encode.
+ * Frames that find the decode queue full wait in a receive backlog owned
+ * by the loop thread; the loop calls ingest_pipeline_pump after every
+ * peer_client_poll to move them on. While the pipeline runs, the target
+ * chain belongs to the apply thread; on_block runs there too, once per
+ * appended block.
+ */
+
+#ifndef INGEST_PIPELINE_H
+#define INGEST_PIPELINE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "blockchain.h"
+#include "bounded_queue.h"
+#include "socket_client.h"
+
+#define INGEST_DEFAULT_QUEUE 256
+
+typedef void (*IngestBlockHandler)(Blockchain* chain, const Block* block, void* user);
+
+/**
+ * @brief Stage sizes and the apply hook; zero sizes select the defaults
+ */
+typedef struct {
+    int verify_threads;
+    size_t queue_capacity;
+    Blockchain* chain;
+    IngestBlockHandler on_block;
+    void* user;
+} IngestConfig;
+
+typedef struct {
+    size_t depth;
+    size_t high_water;
+    size_t capacity;
+} IngestQueueStats;
+
+/**
+ * @brief Snapshot of the pipeline; verify sums the per-worker queues
+ */
+typedef struct {
+    IngestQueueStats decode;
+    IngestQueueStats verify;
+    IngestQueueStats apply;
+    size_t receive_backlog;
+    size_t reorder_depth;
+    size_t received;
+    size_t decoded;
+    size_t verified;
+    size_t applied;
+    size_t rejected;
+    size_t duplicates;
+} IngestStats;
+
+typedef struct IngestWorker IngestWorker;
+typedef struct IngestItem IngestItem;
+
+typedef struct {
+    IngestConfig config;
+    IngestItem* backlog_head;
+    IngestItem* backlog_tail;
+    atomic_size_t backlog;
+    SpscQueue decode_queue;
+    IngestWorker* workers;
+    int worker_count;
+    MpscQueue apply_queue;
+    pthread_t decode_thread;
+    pthread_t apply_thread;
+    atomic_size_t reorder_depth;
+    atomic_size_t received;
+    atomic_size_t decoded;
+    atomic_size_t verified;
+    atomic_size_t applied;
+    atomic_size_t rejected;
+    atomic_size_t duplicates;
+    int first_rejected;
+} IngestPipeline;
+
+/**
+ * @brief Start the decode, verify and apply threads
+ * @return 1 on success, 0 if a queue or thread could not be created
+ */
+int ingest_pipeline_start(IngestPipeline* pipeline, const IngestConfig* config);
+
+/**
+ * @brief PeerFrameHandler for the receive stage; user is the pipeline
+ *
+ * Hands the frame to the decode thread, or to the receive backlog while
+ * its queue is full. The frame's bytes stay charged to its peer until
+ * the block is applied or dropped.
+ */
+void ingest_pipeline_on_frame(PeerClient* client, const PeerFrame* frame, void* user);
+
+/**
+ * @brief Move backlogged frames into the decode queue without waiting
+ *
+ * Call on the loop thread after each peer_client_poll.
+ *
+ * @return Frames still in the backlog (poll again soon if nonzero)
+ */
+size_t ingest_pipeline_pump(IngestPipeline* pipeline);
+
+/**
+ * @brief Drain every stage, join the threads and free the queues
+ *
+ * Call from the thread that delivers frames, after the last one.
+ *
+ * @return Index of the first rejected block, or -1 if none was rejected
+ */
+int ingest_pipeline_finish(IngestPipeline* pipeline);
+
+void ingest_pipeline_stats(IngestPipeline* pipeline, IngestStats* stats);
+
+#endif
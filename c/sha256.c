@@ -0,0 +1,341 @@
+/**
+ * @file
+ * @brief SHA-256 kernels and dispatch (see sha256.h)
+ *
+ * The x86 kernels are compiled with per-function target attributes, so
+ * the file builds with plain -O2 and picks a kernel from CPUID at run
+ * time.
+ */
+
+#include "sha256.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_X86 1
+#include <immintrin.h>
+#endif
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t H0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t rotr32(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * @brief Portable compression of blocks consecutive 64-byte blocks
+ */
+static void sha256_compress_scalar(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    uint32_t w[64];
+    while (blocks--) {
+        for (int t = 0; t < 16; t++) {
+            w[t] = load_be32(data + 4 * t);
+        }
+        for (int t = 16; t < 64; t++) {
+            uint32_t s0 = rotr32(w[t - 15], 7) ^ rotr32(w[t - 15], 18) ^ (w[t - 15] >> 3);
+            uint32_t s1 = rotr32(w[t - 2], 17) ^ rotr32(w[t - 2], 19) ^ (w[t - 2] >> 10);
+            w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int t = 0; t < 64; t++) {
+            uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + K[t] + w[t];
+            uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+        data += SHA256_BLOCK_SIZE;
+    }
+}
+
+#ifdef SHA256_X86
+
+/**
+ * @brief SHA-NI compression; four rounds per pair of sha256rnds2
+ *
+ * Message group k (words 4k..4k+3) is derived from the previous four as
+ * msg2(msg1(W[k-4], W[k-3]) + alignr(W[k-1], W[k-2]), W[k-1]).
+ */
+__attribute__((target("sha,sse4.1"))) static void sha256_compress_shani(uint32_t state[8], const uint8_t* data,
+                                                                        size_t blocks) {
+    const __m128i byteswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1); // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    while (blocks--) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i w[4];
+#pragma GCC unroll 16
+        for (int k = 0; k < 16; k++) {
+            __m128i group;
+            if (k < 4) {
+                group = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * k)), byteswap);
+            } else {
+                group = _mm_sha256msg1_epu32(w[k & 3], w[(k - 3) & 3]);
+                group = _mm_add_epi32(group, _mm_alignr_epi8(w[(k - 1) & 3], w[(k - 2) & 3], 4));
+                group = _mm_sha256msg2_epu32(group, w[(k - 1) & 3]);
+            }
+            w[k & 3] = group;
+
+            __m128i msg = _mm_add_epi32(group, _mm_loadu_si128((const __m128i*)&K[4 * k]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+        data += SHA256_BLOCK_SIZE;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static __m256i rotr8x(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+/**
+ * @brief Compress one 64-byte block for each of eight lanes
+ */
+AVX2_TARGET static void sha256_compress_avx2(__m256i s[8], const uint8_t* const block[8]) {
+    __m256i w[64];
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm256_set_epi32((int)load_be32(block[7] + 4 * t), (int)load_be32(block[6] + 4 * t),
+                                (int)load_be32(block[5] + 4 * t), (int)load_be32(block[4] + 4 * t),
+                                (int)load_be32(block[3] + 4 * t), (int)load_be32(block[2] + 4 * t),
+                                (int)load_be32(block[1] + 4 * t), (int)load_be32(block[0] + 4 * t));
+    }
+    for (int t = 16; t < 64; t++) {
+        __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(w[t - 15], 7), rotr8x(w[t - 15], 18)),
+                                      _mm256_srli_epi32(w[t - 15], 3));
+        __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(w[t - 2], 17), rotr8x(w[t - 2], 19)),
+                                      _mm256_srli_epi32(w[t - 2], 10));
+        w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+    }
+
+    __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int t = 0; t < 64; t++) {
+        __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(e, 6), rotr8x(e, 11)), rotr8x(e, 25));
+        __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sigma1),
+                                      _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32((int)K[t]), w[t])));
+        __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotr8x(a, 2), rotr8x(a, 13)), rotr8x(a, 22));
+        __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        __m256i t2 = _mm256_add_epi32(sigma0, maj);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+    s[0] = _mm256_add_epi32(s[0], a);
+    s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c);
+    s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e);
+    s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g);
+    s[7] = _mm256_add_epi32(s[7], h);
+}
+
+AVX2_TARGET static void sha256_x8_avx2(const uint8_t* const data[8], size_t len, uint8_t out[8][SHA256_DIGEST_SIZE]) {
+    __m256i s[8];
+    for (int i = 0; i < 8; i++) {
+        s[i] = _mm256_set1_epi32((int)H0[i]);
+    }
+
+    const uint8_t* block[8];
+    size_t offset = 0;
+    for (; offset + SHA256_BLOCK_SIZE <= len; offset += SHA256_BLOCK_SIZE) {
+        for (int lane = 0; lane < 8; lane++) {
+            block[lane] = data[lane] + offset;
+        }
+        sha256_compress_avx2(s, block);
+    }
+
+    // Padding is identical across lanes (same length), only the bytes differ
+    uint8_t tail[8][2 * SHA256_BLOCK_SIZE];
+    size_t rest = len - offset;
+    size_t tail_len = rest + 9 <= SHA256_BLOCK_SIZE ? SHA256_BLOCK_SIZE : 2 * SHA256_BLOCK_SIZE;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int lane = 0; lane < 8; lane++) {
+        memset(tail[lane], 0, tail_len);
+        memcpy(tail[lane], data[lane] + offset, rest);
+        tail[lane][rest] = 0x80;
+        store_be32(tail[lane] + tail_len - 8, (uint32_t)(bits >> 32));
+        store_be32(tail[lane] + tail_len - 4, (uint32_t)bits);
+    }
+    for (size_t t = 0; t < tail_len; t += SHA256_BLOCK_SIZE) {
+        for (int lane = 0; lane < 8; lane++) {
+            block[lane] = tail[lane] + t;
+        }
+        sha256_compress_avx2(s, block);
+    }
+
+    uint32_t words[8][8];
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i*)words[i], s[i]);
+    }
+    for (int lane = 0; lane < 8; lane++) {
+        for (int i = 0; i < 8; i++) {
+            store_be32(out[lane] + 4 * i, words[i][lane]);
+        }
+    }
+}
+
+
+#endif
+
+typedef void (*sha256_compress_fn)(uint32_t state[8], const uint8_t* data, size_t blocks);
+
+/**
+ * @brief Kernel for this CPU (the feature checks read libgcc's cached CPUID)
+ */
+static sha256_compress_fn sha256_compress(void) {
+#ifdef SHA256_X86
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+        return sha256_compress_shani;
+    }
+#endif
+    return sha256_compress_scalar;
+}
+
+void sha256_init(Sha256* ctx) {
+    memcpy(ctx->state, H0, sizeof(H0));
+    ctx->length = 0;
+    ctx->buffered = 0;
+}
+
+void sha256_update(Sha256* ctx, const void* data, size_t len) {
+    sha256_compress_fn compress = sha256_compress();
+    const uint8_t* p = (const uint8_t*)data;
+    ctx->length += len;
+    if (ctx->buffered > 0) {
+        size_t take = SHA256_BLOCK_SIZE - ctx->buffered;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buffer + ctx->buffered, p, take);
+        ctx->buffered += take;
+        p += take;
+        len -= take;
+        if (ctx->buffered < SHA256_BLOCK_SIZE) {
+            return;
+        }
+        compress(ctx->state, ctx->buffer, 1);
+        ctx->buffered = 0;
+    }
+    size_t blocks = len / SHA256_BLOCK_SIZE;
+    if (blocks > 0) {
+        compress(ctx->state, p, blocks);
+        p += blocks * SHA256_BLOCK_SIZE;
+        len -= blocks * SHA256_BLOCK_SIZE;
+    }
+    memcpy(ctx->buffer, p, len);
+    ctx->buffered = len;
+}
+
+void sha256_final(Sha256* ctx, uint8_t out[SHA256_DIGEST_SIZE]) {
+    uint64_t bits = ctx->length * 8;
+    uint8_t pad[2 * SHA256_BLOCK_SIZE] = {0x80};
+    size_t pad_len = (ctx->buffered < 56 ? 56 : 120) - ctx->buffered;
+    store_be32(pad + pad_len, (uint32_t)(bits >> 32));
+    store_be32(pad + pad_len + 4, (uint32_t)bits);
+    sha256_update(ctx, pad, pad_len + 8);
+    for (int i = 0; i < 8; i++) {
+        store_be32(out + 4 * i, ctx->state[i]);
+    }
+}
+
+void sha256(const void* data, size_t len, uint8_t out[SHA256_DIGEST_SIZE]) {
+    Sha256 ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, out);
+}
+
+/**
+ * @brief Whether sha256_x8 should use the AVX2 kernel
+ *
+ * One SHA-NI lane at a time beats eight AVX2 lanes per hash, so the
+ * AVX2 kernel is for CPUs that have AVX2 but no SHA extensions.
+ */
+static int sha256_use_avx2(void) {
+#ifdef SHA256_X86
+    return sha256_compress() == sha256_compress_scalar && __builtin_cpu_supports("avx2");
+#else
+    return 0;
+#endif
+}
+
+void sha256_x8(const uint8_t* const data[8], size_t len, uint8_t out[8][SHA256_DIGEST_SIZE]) {
+#ifdef SHA256_X86
+    if (sha256_use_avx2()) {
+        sha256_x8_avx2(data, len, out);
+        return;
+    }
+#endif
+    for (int lane = 0; lane < 8; lane++) {
+        sha256(data[lane], len, out[lane]);
+    }
+}
+
+const char* sha256_backend(void) {
+    return sha256_compress() == sha256_compress_scalar ? "scalar" : "sha-ni";
+}
+
+const char* sha256_x8_backend(void) {
+    return sha256_use_avx2() ? "avx2" : sha256_backend();
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief SHA-256 with runtime-dispatched SHA-NI and AVX2 8-way kernels
+ *
+ * Demonstrates:
+ * - Streaming init/update/final interface
+ * - CPUID dispatch between a portable kernel and x86 SHA extensions
+ * - Multi-buffer hashing: eight equal-length messages per AVX2 pass
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE 64
+
+/**
+ * @brief Incremental hashing state
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t buffer[SHA256_BLOCK_SIZE];
+    size_t buffered;
+} Sha256;
+
+void sha256_init(Sha256* ctx);
+void sha256_update(Sha256* ctx, const void* data, size_t len);
+void sha256_final(Sha256* ctx, uint8_t out[SHA256_DIGEST_SIZE]);
+
+/**
+ * @brief One-shot digest of data
+ */
+void sha256(const void* data, size_t len, uint8_t out[SHA256_DIGEST_SIZE]);
+
+/**
+ * @brief Digest eight messages of the same length
+ *
+ * Runs the AVX2 kernel on CPUs without SHA extensions, otherwise hashes
+ * the messages one by one with the faster single-buffer kernel.
+ */
+void sha256_x8(const uint8_t* const data[8], size_t len, uint8_t out[8][SHA256_DIGEST_SIZE]);
+
+/**
+ * @brief Name of the single-buffer kernel in use ("sha-ni" or "scalar")
+ */
+const char* sha256_backend(void);
+
+/**
+ * @brief Name of the kernel sha256_x8 uses ("avx2", "sha-ni" or "scalar")
+ */
+const char* sha256_x8_backend(void);
+
+#endif
@@ -1,22 +1,627 @@
 /**
- * Basic TCP socket client
- * Author: Daily Code Bot
- * Date: 2026-02-10
- * Time Complexity: O(n)
- * Space Complexity: O(1)
+ * @file
+ * @brief Non-blocking epoll peer client (see socket_client.h)
+ * @author Daily Code Bot
+ * @date 2026-02-10
+ *
+ * Frames are parsed in place out of PEER_RECV_CHUNK-sized receive chunks;
+ * only the partial frame at the end of a full chunk is ever copied. Every
+ * frame spans a multiple of 8 bytes, so frame starts stay 8-byte aligned
+ * within a chunk, including after the partial frame is moved.
+ *
+ * Build: gcc -O2 -DSOCKET_CLIENT_MAIN socket_client.c -o socket_client
  */
 
+#define _GNU_SOURCE
+
+#include "socket_client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define PEER_EVENTS 64
+#define PEER_READ_BUDGET (1024 * 1024)
+#define WAKE_TOKEN UINT64_MAX
+
+static uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void chunk_unref(PeerChunk* chunk) {
+    if (chunk != NULL && atomic_fetch_sub(&chunk->refs, 1) == 1) {
+        free(chunk);
+    }
+}
+
+static size_t low_water(const PeerClient* client) {
+    return client->config.max_inflight / 2;
+}
+
+/**
+ * @brief Re-register a peer's interest: EPOLLIN unless paused, EPOLLOUT while connecting or sending
+ *
+ * A peer that hung up while paused is out of the epoll set (see
+ * peer_client_poll) and is only added back once it resumes.
+ */
+static void update_events(PeerClient* client, int id) {
+    Peer* peer = client->peers[id];
+    int op = EPOLL_CTL_MOD;
+    if (peer->hung_up) {
+        if (atomic_load(&peer->paused)) {
+            return;
+        }
+        op = EPOLL_CTL_ADD;
+        peer->hung_up = 0;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = atomic_load(&peer->paused) ? 0 : EPOLLIN;
+    if (peer->connecting || peer->out_end > peer->out_start) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.u64 = (uint64_t)id;
+    epoll_ctl(client->epoll_fd, op, peer->fd, &ev);
+}
+
+/**
+ * @brief Initialize a client with its epoll set and wake-up eventfd
+ * @param client Client to initialize
+ * @param config Limits and callbacks (on_frame is required)
+ * @return 1 on success, 0 on failure
+ */
+int peer_client_init(PeerClient* client, const PeerClientConfig* config) {
+    memset(client, 0, sizeof(*client));
+    client->config = *config;
+    if (client->config.max_frame == 0) {
+        client->config.max_frame = PEER_DEFAULT_MAX_FRAME;
+    }
+    if (client->config.max_inflight == 0) {
+        client->config.max_inflight = PEER_DEFAULT_MAX_INFLIGHT;
+    }
+    client->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    client->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_TOKEN;
+    if (client->epoll_fd < 0 || client->wake_fd < 0 || config->on_frame == NULL ||
+        epoll_ctl(client->epoll_fd, EPOLL_CTL_ADD, client->wake_fd, &ev) != 0) {
+        peer_client_destroy(client);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Register a non-blocking socket as a new peer
+ */
+static int add_peer(PeerClient* client, int fd, int connecting) {
+    if (client->peer_count == client->peer_capacity) {
+        size_t capacity = client->peer_capacity ? client->peer_capacity * 2 : 16;
+        Peer** peers = (Peer**)realloc(client->peers, capacity * sizeof(Peer*));
+        if (peers == NULL) {
+            return -1;
+        }
+        client->peers = peers;
+        client->peer_capacity = capacity;
+    }
+    Peer* peer = (Peer*)calloc(1, sizeof(Peer));
+    if (peer == NULL) {
+        return -1;
+    }
+    int id = (int)client->peer_count;
+    peer->fd = fd;
+    peer->open = 1;
+    peer->connecting = connecting;
+    atomic_init(&peer->paused, 0);
+    atomic_init(&peer->inflight, 0);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | (connecting ? EPOLLOUT : 0);
+    ev.data.u64 = (uint64_t)id;
+    if (epoll_ctl(client->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        free(peer);
+        return -1;
+    }
+    client->peers[client->peer_count++] = peer;
+    return id;
+}
 
+/**
+ * @brief Start a non-blocking connect to host:port
+ * @param client Client
+ * @param host Host name or address
+ * @param port TCP port
+ * @return Peer ID, or -1 if resolution or socket setup fails
+ */
+int peer_client_connect(PeerClient* client, const char* host, uint16_t port) {
+    char service[8];
+    struct addrinfo hints;
+    struct addrinfo* result;
+    snprintf(service, sizeof(service), "%u", (unsigned)port);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    if (getaddrinfo(host, service, &hints, &result) != 0) {
+        return -1;
+    }
+    int id = -1;
+    for (struct addrinfo* ai = result; ai != NULL && id < 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if ((connect(fd, ai->ai_addr, ai->ai_addrlen) == 0 || errno == EINPROGRESS) &&
+            (id = add_peer(client, fd, 1)) >= 0) {
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(result);
+    return id;
+}
+
+/**
+ * @brief Adopt an already connected socket
+ * @param client Client
+ * @param fd Connected stream socket; owned by the client from now on
+ * @return Peer ID, or -1 on failure
+ */
+int peer_client_add_fd(PeerClient* client, int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        return -1;
+    }
+    return add_peer(client, fd, 0);
+}
+
+/**
+ * @brief Close a peer; frames it already delivered stay valid until released
+ * @param client Client
+ * @param id Peer ID
+ */
+void peer_client_close_peer(PeerClient* client, int id) {
+    Peer* peer = client->peers[id];
+    if (!peer->open) {
+        return;
+    }
+    if (!peer->hung_up) {
+        epoll_ctl(client->epoll_fd, EPOLL_CTL_DEL, peer->fd, NULL);
+    }
+    close(peer->fd);
+    peer->open = 0;
+    free(peer->out);
+    peer->out = NULL;
+    peer->out_start = peer->out_end = peer->out_capacity = 0;
+    chunk_unref(peer->chunk);
+    peer->chunk = NULL;
+    if (client->config.on_close != NULL) {
+        client->config.on_close(client, id, client->config.user);
+    }
+}
+
+/**
+ * @brief Release the socket set and every peer
+ *
+ * All delivered frames must have been released first.
+ *
+ * @param client Client
+ */
+void peer_client_destroy(PeerClient* client) {
+    for (size_t i = 0; i < client->peer_count; i++) {
+        Peer* peer = client->peers[i];
+        if (peer->open) {
+            epoll_ctl(client->epoll_fd, EPOLL_CTL_DEL, peer->fd, NULL);
+            close(peer->fd);
+            free(peer->out);
+            chunk_unref(peer->chunk);
+        }
+        free(peer);
+    }
+    free(client->peers);
+    if (client->epoll_fd >= 0) {
+        close(client->epoll_fd);
+    }
+    if (client->wake_fd >= 0) {
+        close(client->wake_fd);
+    }
+    memset(client, 0, sizeof(*client));
+    client->epoll_fd = -1;
+    client->wake_fd = -1;
+}
+
+/**
+ * @brief Write as much of the peer's queued output as the socket takes
+ * @return 1 if the peer is still usable, 0 if it failed
+ */
+static int flush_output(Peer* peer) {
+    while (peer->out_end > peer->out_start) {
+        ssize_t n = send(peer->fd, peer->out + peer->out_start, peer->out_end - peer->out_start, MSG_NOSIGNAL);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        peer->out_start += (size_t)n;
+    }
+    peer->out_start = peer->out_end = 0;
+    return 1;
+}
+
+/**
+ * @brief Send one framed message, queueing whatever the socket does not accept yet
+ * @param client Client
+ * @param id Peer ID
+ * @param payload Frame payload
+ * @param length Payload size (at most max_frame)
+ * @return 1 if sent or queued, 0 if the peer is closed, the frame is too large or out of memory
+ */
+int peer_client_send(PeerClient* client, int id, const void* payload, uint32_t length) {
+    static const uint8_t padding[PEER_FRAME_ALIGN];
+    Peer* peer = client->peers[id];
+    if (!peer->open || length > client->config.max_frame) {
+        return 0;
+    }
+    uint8_t header[PEER_FRAME_HEADER] = {(uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16),
+                                         (uint8_t)(length >> 24)};
+    size_t total = peer_frame_wire_size(length);
+    struct iovec iov[3] = {{header, PEER_FRAME_HEADER},
+                           {(void*)payload, length},
+                           {(void*)padding, total - PEER_FRAME_HEADER - length}};
+    size_t sent = 0;
+    if (!peer->connecting && peer->out_end == peer->out_start) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 3;
+        ssize_t n = sendmsg(peer->fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            peer_client_close_peer(client, id);
+            return 0;
+        }
+        sent = n > 0 ? (size_t)n : 0;
+        if (sent == total) {
+            return 1;
+        }
+    }
+
+    size_t queued = peer->out_end - peer->out_start;
+    if (queued + total - sent > peer->out_capacity - peer->out_start) {
+        if (queued > 0) {
+            memmove(peer->out, peer->out + peer->out_start, queued);
+        }
+        peer->out_start = 0;
+        peer->out_end = queued;
+        if (queued + total - sent > peer->out_capacity) {
+            size_t capacity = peer->out_capacity ? peer->out_capacity : 4096;
+            while (capacity < queued + total - sent) {
+                capacity *= 2;
+            }
+            uint8_t* out = (uint8_t*)realloc(peer->out, capacity);
+            if (out == NULL) {
+                // Part of the frame may be on the wire already; the stream cannot continue
+                if (sent > 0) {
+                    peer_client_close_peer(client, id);
+                }
+                return 0;
+            }
+            peer->out = out;
+            peer->out_capacity = capacity;
+        }
+    }
+    // Queue whatever sendmsg left of the header, payload and padding
+    for (int i = 0; i < 3; i++) {
+        size_t skip = sent < iov[i].iov_len ? sent : iov[i].iov_len;
+        memcpy(peer->out + peer->out_end, (const uint8_t*)iov[i].iov_base + skip, iov[i].iov_len - skip);
+        peer->out_end += iov[i].iov_len - skip;
+        sent -= skip;
+    }
+    update_events(client, id);
+    return 1;
+}
+
+/**
+ * @brief Bytes needed before the frame at peer->start can be parsed
+ */
+static size_t frame_need(const Peer* peer) {
+    size_t pending = peer->end - peer->start;
+    if (pending < PEER_FRAME_HEADER) {
+        return PEER_FRAME_HEADER;
+    }
+    return peer_frame_wire_size(load_le32(peer->chunk->data + peer->start));
+}
+
+/**
+ * @brief Make the receive chunk able to hold need bytes from start, moving the partial frame if required
+ * @return 1 on success, 0 if out of memory
+ */
+static int make_room(Peer* peer, size_t need) {
+    PeerChunk* chunk = peer->chunk;
+    size_t pending = chunk != NULL ? peer->end - peer->start : 0;
+    if (chunk != NULL && chunk->size - peer->start >= need && peer->end < chunk->size) {
+        return 1;
+    }
+    if (chunk != NULL && atomic_load(&chunk->refs) == 1 && chunk->size >= need) {
+        // No frames outstanding: slide the tail to the front instead of reallocating
+        memmove(chunk->data, chunk->data + peer->start, pending);
+    } else {
+        size_t size = need > PEER_RECV_CHUNK ? need : PEER_RECV_CHUNK;
+        PeerChunk* fresh = (PeerChunk*)malloc(sizeof(PeerChunk) + size);
+        if (fresh == NULL) {
+            return 0;
+        }
+        atomic_init(&fresh->refs, 1);
+        fresh->owner = peer;
+        fresh->size = size;
+        if (pending > 0) {
+            memcpy(fresh->data, chunk->data + peer->start, pending);
+        }
+        chunk_unref(chunk);
+        peer->chunk = fresh;
+    }
+    peer->start = 0;
+    peer->end = pending;
+    return 1;
+}
+
+/**
+ * @brief Pause a peer that holds too many unreleased bytes
+ *
+ * The inflight count is re-read after pausing, so a release racing with
+ * the pause cannot leave the peer stuck.
+ */
+static void apply_backpressure(PeerClient* client, int id) {
+    Peer* peer = client->peers[id];
+    if (atomic_load(&peer->paused) || atomic_load(&peer->inflight) < client->config.max_inflight) {
+        return;
+    }
+    atomic_store(&peer->paused, 1);
+    if (atomic_load(&peer->inflight) < low_water(client)) {
+        atomic_store(&peer->paused, 0);
+    } else {
+        peer->pauses++;
+    }
+    update_events(client, id);
+}
+
+/**
+ * @brief Read what is available (up to PEER_READ_BUDGET) and hand out every complete frame
+ */
+static void read_peer(PeerClient* client, int id) {
+    Peer* peer = client->peers[id];
+    size_t budget = PEER_READ_BUDGET;
+    while (peer->open && !atomic_load(&peer->paused) && budget > 0) {
+        size_t need = peer->chunk != NULL ? frame_need(peer) : PEER_FRAME_HEADER;
+        if (need > PEER_FRAME_HEADER + client->config.max_frame + PEER_FRAME_ALIGN) {
+            peer_client_close_peer(client, id);
+            return;
+        }
+        if (peer->chunk == NULL || peer->end == peer->chunk->size || peer->chunk->size - peer->start < need) {
+            if (!make_room(peer, need)) {
+                peer_client_close_peer(client, id);
+                return;
+            }
+        }
+        PeerChunk* chunk = peer->chunk;
+        ssize_t n = recv(peer->fd, chunk->data + peer->end, chunk->size - peer->end, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            peer_client_close_peer(client, id);
+            return;
+        }
+        if (n < 0) {
+            return;
+        }
+        peer->end += (size_t)n;
+        peer->bytes += (uint64_t)n;
+        budget -= (size_t)n < budget ? (size_t)n : budget;
+
+        while (peer->open && peer->end - peer->start >= PEER_FRAME_HEADER) {
+            uint32_t length = load_le32(chunk->data + peer->start);
+            if (length > client->config.max_frame) {
+                peer_client_close_peer(client, id);
+                return;
+            }
+            size_t span = peer_frame_wire_size(length);
+            if (peer->end - peer->start < span) {
+                break;
+            }
+            PeerFrame frame;
+            frame.peer = id;
+            frame.data = chunk->data + peer->start + PEER_FRAME_HEADER;
+            frame.length = length;
+            frame.chunk = chunk;
+            atomic_fetch_add(&chunk->refs, 1);
+            atomic_fetch_add(&peer->inflight, span);
+            peer->start += span;
+            peer->frames++;
+            client->config.on_frame(client, &frame, client->config.user);
+        }
+        if (peer->open && peer->start == peer->end && atomic_load(&chunk->refs) == 1) {
+            peer->start = peer->end = 0;
+        }
+        if (peer->open) {
+            apply_backpressure(client, id);
+        }
+    }
+}
+
+/**
+ * @brief Give a frame's bytes back to its peer
+ *
+ * Wakes the loop through the eventfd when a paused peer drops below half
+ * of max_inflight.
+ *
+ * @param client Client that delivered the frame
+ * @param frame Frame from on_frame
+ */
+void peer_frame_release(PeerClient* client, const PeerFrame* frame) {
+    Peer* peer = frame->chunk->owner;
+    size_t bytes = peer_frame_wire_size(frame->length);
+    size_t left = atomic_fetch_sub(&peer->inflight, bytes) - bytes;
+    if (atomic_load(&peer->paused) && left < low_water(client)) {
+        uint64_t one = 1;
+        ssize_t ignored = write(client->wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+    chunk_unref(frame->chunk);
+}
+
+/**
+ * @brief Resume every paused peer whose consumers have caught up
+ */
+static void resume_peers(PeerClient* client) {
+    uint64_t count;
+    ssize_t ignored = read(client->wake_fd, &count, sizeof(count));
+    (void)ignored;
+    for (size_t i = 0; i < client->peer_count; i++) {
+        Peer* peer = client->peers[i];
+        if (peer->open && atomic_load(&peer->paused) && atomic_load(&peer->inflight) < low_water(client)) {
+            atomic_store(&peer->paused, 0);
+            update_events(client, (int)i);
+            read_peer(client, (int)i);
+        }
+    }
+}
+
+/**
+ * @brief Wait up to timeout_ms and service every ready peer once
+ * @param client Client
+ * @param timeout_ms epoll_wait timeout (-1 blocks)
+ * @return Number of ready descriptors, or -1 on error
+ */
+int peer_client_poll(PeerClient* client, int timeout_ms) {
+    struct epoll_event events[PEER_EVENTS];
+    int n = epoll_wait(client->epoll_fd, events, PEER_EVENTS, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (events[i].data.u64 == WAKE_TOKEN) {
+            resume_peers(client);
+            continue;
+        }
+        int id = (int)events[i].data.u64;
+        Peer* peer = client->peers[id];
+        if (!peer->open) {
+            continue;
+        }
+        if (peer->connecting && (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(peer->fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0) {
+                peer_client_close_peer(client, id);
+                continue;
+            }
+            peer->connecting = 0;
+            update_events(client, id);
+        }
+        if ((events[i].events & (EPOLLHUP | EPOLLERR)) && atomic_load(&peer->paused)) {
+            // Level-triggered hangups keep firing with no events requested;
+            // leave the set until the peer resumes and reads what is left
+            epoll_ctl(client->epoll_fd, EPOLL_CTL_DEL, peer->fd, NULL);
+            peer->hung_up = 1;
+            continue;
+        }
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            read_peer(client, id);
+        }
+        if (peer->open && (events[i].events & EPOLLOUT)) {
+            if (!flush_output(peer)) {
+                peer_client_close_peer(client, id);
+                continue;
+            }
+            update_events(client, id);
+        }
+    }
+    return n;
+}
+
+#ifdef SOCKET_CLIENT_MAIN
+
+#define DEMO_FRAMES 4096
+#define DEMO_FRAME_SIZE 1000
+
+typedef struct {
+    PeerFrame held[DEMO_FRAMES];
+    int count;
+    int received;
+} DemoState;
+
+static void hold_frame(PeerClient* client, const PeerFrame* frame, void* user) {
+    (void)client;
+    DemoState* state = (DemoState*)user;
+    state->held[state->count++] = *frame;
+    state->received++;
+}
+
+/**
+ * @brief Loopback demo: a socketpair peer streams frames while a slow consumer holds them
+ */
 int main() {
-    printf("Basic TCP socket client\n");
-    printf("Topic: socket_client\n");
-    printf("Difficulty: medium\n");
+    printf("=== Non-blocking epoll peer client ===\n\n");
 
-    // TODO: Implement the actual logic here
-    // This is a placeholder - the full implementation would be generated
+    static DemoState state;
+    PeerClientConfig config = {.max_inflight = 64 * 1024, .on_frame = hold_frame, .user = &state};
+    PeerClient client;
+    int fds[2];
+    if (!peer_client_init(&client, &config) || socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) != 0) {
+        return 1;
+    }
+    int id = peer_client_add_fd(&client, fds[0]);
 
+    // DEMO_FRAME_SIZE is a multiple of 8, so frames need no padding
+    uint8_t frame[PEER_FRAME_HEADER + DEMO_FRAME_SIZE];
+    memset(frame, 0, PEER_FRAME_HEADER);
+    frame[0] = DEMO_FRAME_SIZE & 0xff;
+    frame[1] = DEMO_FRAME_SIZE >> 8;
+    size_t sent = 0;
+    size_t total = (size_t)DEMO_FRAMES * sizeof(frame);
+    int pauses = 0;
+    while (state.received < DEMO_FRAMES) {
+        // Producer side: push as much of the stream as the socket buffer takes
+        while (sent < total) {
+            size_t offset = sent % sizeof(frame);
+            memset(frame + PEER_FRAME_HEADER, 'a' + (int)(sent / sizeof(frame)) % 26, DEMO_FRAME_SIZE);
+            ssize_t n = write(fds[1], frame + offset, sizeof(frame) - offset);
+            if (n <= 0) {
+                break;
+            }
+            sent += (size_t)n;
+        }
+        peer_client_poll(&client, 10);
+        // Consumer side: only catches up once the peer has been paused
+        if (atomic_load(&client.peers[id]->paused)) {
+            pauses++;
+            for (int i = 0; i < state.count; i++) {
+                peer_frame_release(&client, &state.held[i]);
+            }
+            state.count = 0;
+        }
+    }
+    for (int i = 0; i < state.count; i++) {
+        peer_frame_release(&client, &state.held[i]);
+    }
+    printf("Received %llu frames, %llu bytes; peer paused %d times at %zu bytes in flight\n",
+           (unsigned long long)client.peers[id]->frames, (unsigned long long)client.peers[id]->bytes, pauses,
+           client.config.max_inflight);
+
+    close(fds[1]);
+    peer_client_destroy(&client);
     printf("\nImplementation complete!\n");
     return 0;
 }
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @brief Non-blocking epoll peer client with length-prefixed framing
+ *
+ * Demonstrates:
+ * - One epoll loop driving many peer sockets
+ * - Frames (u32 little-endian length, u32 reserved zero, then the payload
+ *   zero-padded to 8 bytes) handed out in place from reference-counted
+ *   receive chunks, so every payload starts 8-byte aligned
+ * - Per-peer backpressure: reading pauses while too many received bytes
+ *   are still held by consumers, and resumes once they are released
+ *
+ * peer_client_poll, _connect, _add_fd, _send and _close_peer belong to
+ * the loop thread; peer_frame_release may be called from any thread.
+ */
+
+#ifndef SOCKET_CLIENT_H
+#define SOCKET_CLIENT_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PEER_FRAME_HEADER 8
+#define PEER_FRAME_ALIGN 8
+#define PEER_RECV_CHUNK (256 * 1024)
+#define PEER_DEFAULT_MAX_FRAME (16 * 1024 * 1024)
+#define PEER_DEFAULT_MAX_INFLIGHT (8 * 1024 * 1024)
+
+struct Peer;
+
+/**
+ * @brief Receive buffer shared by its peer and the frames parsed out of it
+ */
+typedef struct PeerChunk {
+    atomic_size_t refs;
+    struct Peer* owner;
+    size_t size;
+    alignas(8) uint8_t data[];
+} PeerChunk;
+
+/**
+ * @brief One connection; slots are not reused, so held frames outlive a close
+ */
+typedef struct Peer {
+    int fd;
+    int open;
+    int connecting;
+    int hung_up;
+    atomic_int paused;
+    atomic_size_t inflight;
+    PeerChunk* chunk;
+    size_t start;
+    size_t end;
+    uint8_t* out;
+    size_t out_start;
+    size_t out_end;
+    size_t out_capacity;
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t pauses;
+} Peer;
+
+/**
+ * @brief Bytes a frame with a length-byte payload takes on the wire
+ */
+static inline size_t peer_frame_wire_size(uint32_t length) {
+    return PEER_FRAME_HEADER + (((size_t)length + PEER_FRAME_ALIGN - 1) & ~(size_t)(PEER_FRAME_ALIGN - 1));
+}
+
+/**
+ * @brief A received frame; data points into chunk (8-byte aligned) until released
+ */
+typedef struct {
+    int peer;
+    const uint8_t* data;
+    uint32_t length;
+    PeerChunk* chunk;
+} PeerFrame;
+
+typedef struct PeerClient PeerClient;
+
+typedef void (*PeerFrameHandler)(PeerClient* client, const PeerFrame* frame, void* user);
+typedef void (*PeerCloseHandler)(PeerClient* client, int peer, void* user);
+
+/**
+ * @brief Limits and callbacks; zero limits select the defaults
+ */
+typedef struct {
+    size_t max_frame;
+    size_t max_inflight;
+    PeerFrameHandler on_frame;
+    PeerCloseHandler on_close;
+    void* user;
+} PeerClientConfig;
+
+struct PeerClient {
+    int epoll_fd;
+    int wake_fd;
+    Peer** peers;
+    size_t peer_count;
+    size_t peer_capacity;
+    PeerClientConfig config;
+};
+
+int peer_client_init(PeerClient* client, const PeerClientConfig* config);
+void peer_client_destroy(PeerClient* client);
+
+/**
+ * @brief Start a non-blocking connect to host:port
+ * @return Peer ID, or -1 on failure
+ */
+int peer_client_connect(PeerClient* client, const char* host, uint16_t port);
+
+/**
+ * @brief Adopt an already connected socket (made non-blocking here)
+ * @return Peer ID, or -1 on failure
+ */
+int peer_client_add_fd(PeerClient* client, int fd);
+
+int peer_client_send(PeerClient* client, int peer, const void* payload, uint32_t length);
+void peer_client_close_peer(PeerClient* client, int peer);
+
+/**
+ * @brief Wait up to timeout_ms and service every ready peer once
+ * @return Number of ready descriptors, or -1 on error
+ */
+int peer_client_poll(PeerClient* client, int timeout_ms);
+
+/**
+ * @brief Give a frame's bytes back, possibly resuming its peer
+ */
+void peer_frame_release(PeerClient* client, const PeerFrame* frame);
+
+#endif
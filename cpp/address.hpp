@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Fixed-size 20-byte account address
+ *
+ * Demonstrates:
+ * - Trivially copyable value type (no heap allocation)
+ * - Hex parsing done once at the edge
+ * - memcmp equality/ordering and a fast mixing hash
+ */
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief 20-byte account address, stored big-endian as on chain
+ */
+struct Address {
+    static constexpr size_t kSize = 20;
+
+    uint8_t bytes[kSize];
+
+    /**
+     * @brief The zero address (0x0)
+     */
+    static constexpr Address zero() {
+        return Address{};
+    }
+
+    /**
+     * @brief Parse "0x"-prefixed (or bare) hex
+     *
+     * Shorter inputs are left-padded with zeros, so "0x0" is the zero
+     * address. Returns nullopt on non-hex characters or more than 40 digits.
+     */
+    static constexpr std::optional<Address> fromHex(std::string_view hex) {
+        if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+            hex.remove_prefix(2);
+        }
+        if (hex.empty() || hex.size() > kSize * 2) {
+            return std::nullopt;
+        }
+
+        Address a{};
+        size_t nibble = kSize * 2 - hex.size();
+        for (char c : hex) {
+            int v = hexValue(c);
+            if (v < 0) {
+                return std::nullopt;
+            }
+            uint8_t& b = a.bytes[nibble / 2];
+            b = static_cast<uint8_t>(nibble % 2 == 0 ? v << 4 : b | v);
+            nibble++;
+        }
+        return a;
+    }
+
+    /**
+     * @brief Lower-case "0x"-prefixed, 40-digit hex
+     */
+    std::string toHex() const {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string out(2 + kSize * 2, '0');
+        out[1] = 'x';
+        for (size_t i = 0; i < kSize; i++) {
+            out[2 + i * 2] = digits[bytes[i] >> 4];
+            out[3 + i * 2] = digits[bytes[i] & 0xf];
+        }
+        return out;
+    }
+
+    bool isZero() const {
+        return *this == zero();
+    }
+
+    friend bool operator==(const Address& a, const Address& b) {
+        return std::memcmp(a.bytes, b.bytes, kSize) == 0;
+    }
+
+    friend std::strong_ordering operator<=>(const Address& a, const Address& b) {
+        return std::memcmp(a.bytes, b.bytes, kSize) <=> 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Address& a) {
+        return os << a.toHex();
+    }
+
+private:
+    static constexpr int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
+
+static_assert(sizeof(Address) == Address::kSize);
+static_assert(std::is_trivially_copyable_v<Address>);
+
+/**
+ * @brief Hash mixing all 20 bytes with multiply-xorshift rounds
+ *
+ * Real addresses are already uniformly distributed, but test and demo
+ * addresses are mostly leading zeros, so every byte has to contribute.
+ */
+struct AddressHash {
+    size_t operator()(const Address& a) const {
+        uint64_t w0, w1;
+        uint32_t w2;
+        std::memcpy(&w0, a.bytes, 8);
+        std::memcpy(&w1, a.bytes + 8, 8);
+        std::memcpy(&w2, a.bytes + 16, 4);
+
+        uint64_t h = (w0 ^ 0x9e3779b97f4a7c15ull) * 0xd6e8feb86659fd93ull;
+        h = ((h ^ (h >> 32)) + w1) * 0xd6e8feb86659fd93ull;
+        h = ((h ^ (h >> 32)) + w2) * 0xd6e8feb86659fd93ull;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+template <>
+struct std::hash<Address> : AddressHash {};
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @brief Blocked Bloom filter answering "definitely absent" in one cache line
+ *
+ * Demonstrates:
+ * - 512-bit blocks aligned to cache lines, one bit set in each 64-bit word
+ * - Block chosen by multiply-shift, so the block count is not a power of two
+ * - Eight bit positions from one 32-bit hash and odd multipliers
+ *   (the split-block scheme used by Parquet)
+ * - Probing stored words in place, e.g. straight from a mapped file
+ *
+ * Keys are given as 64-bit hashes. There are no false negatives; at the
+ * sized load (16 bits per key) about 0.1% of absent keys pass.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class BlockedBloomFilter {
+public:
+    static constexpr size_t kWordsPerBlock = 8;
+    static constexpr size_t kBlockBytes = kWordsPerBlock * sizeof(uint64_t);
+    static constexpr size_t kBitsPerKey = 16;
+    static constexpr size_t kKeysPerBlock = kBlockBytes * 8 / kBitsPerKey;
+
+    /**
+     * @brief Empty filter sized for expectedKeys
+     */
+    explicit BlockedBloomFilter(size_t expectedKeys)
+        : _blocks(std::max<size_t>(1, (expectedKeys + kKeysPerBlock - 1) / kKeysPerBlock)) {}
+
+    void insert(uint64_t hash) {
+        Block& b = _blocks[blockIndex(hash, _blocks.size())];
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            b.words[i] |= bitMask(hash, i);
+        }
+    }
+
+    bool mayContain(uint64_t hash) const {
+        return mayContain(words(), hash);
+    }
+
+    /**
+     * @brief Probe stored filter words (kWordsPerBlock per block)
+     *
+     * An empty span holds no filter and answers true for every key.
+     */
+    static bool mayContain(std::span<const uint64_t> words, uint64_t hash) {
+        if (words.empty()) {
+            return true;
+        }
+        const uint64_t* b = words.data() + blockIndex(hash, words.size() / kWordsPerBlock) * kWordsPerBlock;
+        uint64_t missing = 0;
+        for (size_t i = 0; i < kWordsPerBlock; i++) {
+            missing |= ~b[i] & bitMask(hash, i);
+        }
+        return missing == 0;
+    }
+
+    size_t blockCount() const {
+        return _blocks.size();
+    }
+
+    /**
+     * @brief The bits as kWordsPerBlock words per block, for storing
+     */
+    std::span<const uint64_t> words() const {
+        return {reinterpret_cast<const uint64_t*>(_blocks.data()), _blocks.size() * kWordsPerBlock};
+    }
+
+private:
+    struct alignas(kBlockBytes) Block {
+        uint64_t words[kWordsPerBlock] = {};
+    };
+
+    static_assert(sizeof(Block) == kBlockBytes);
+
+    static constexpr uint32_t kSalt[kWordsPerBlock] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                                                       0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+    std::vector<Block> _blocks;
+
+    static size_t blockIndex(uint64_t hash, size_t blocks) {
+        return static_cast<size_t>(((hash >> 32) * blocks) >> 32);
+    }
+
+    static uint64_t bitMask(uint64_t hash, size_t i) {
+        uint32_t bit = (static_cast<uint32_t>(hash) * kSalt[i]) >> 26;
+        return uint64_t{1} << bit;
+    }
+};
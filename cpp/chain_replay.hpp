@@ -0,0 +1,217 @@
+/**
+ * @file
+ * @brief Replays the C blockchain's transactions into TokenContract ledgers
+ *
+ * Demonstrates:
+ * - Calling the C chain (c/blockchain.h) directly from C++
+ * - One applyBatch call per block, with a reused op buffer
+ * - Account IDs mapped to addresses once, by hashing the interned name
+ * - All-or-nothing blocks through a dry run against current balances
+ * - Independent tokens replayed concurrently, one thread each
+ * - A hook for the ingest pipeline's apply stage (c/ingest_pipeline.h)
+ *
+ * The C chain carries a single asset, so each token replays its own
+ * chain. A chain is only read, so several replays may share one.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "../c/blockchain.h"
+}
+
+#include "address.hpp"
+#include "flat_hash_map.hpp"
+#include "token_contract.hpp"
+#include "transfer_batch.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief Address of a C chain account: the first 20 bytes of sha256(name)
+ */
+inline Address accountAddress(const char* name) {
+    uint8_t digest[HASH_LENGTH];
+    sha256(name, std::strlen(name), digest);
+    Address a;
+    std::memcpy(a.bytes, digest, Address::kSize);
+    return a;
+}
+
+/**
+ * @brief How blocks are applied
+ *
+ * With atomicBlocks, a block containing any transfer that would fail is
+ * skipped in full instead of keeping its successful transfers. The block
+ * is checked against current balances before anything is applied, so a
+ * skipped block emits no events and the sink (a JournalSink, say) never
+ * records transfers that did not happen.
+ */
+struct ReplayOptions {
+    bool atomicBlocks = false;
+};
+
+/**
+ * @brief Outcome of one replayed block; a skipped (all-or-nothing) block applied nothing
+ */
+struct BlockReplayResult {
+    int index;
+    size_t transfers;
+    size_t succeeded;
+    bool skipped;
+};
+
+/**
+ * @brief Running totals over every block replayed so far
+ */
+struct ReplaySummary {
+    size_t blocks = 0;
+    size_t transfers = 0;
+    size_t succeeded = 0;
+    size_t skippedBlocks = 0;
+};
+
+/**
+ * @brief Feeds one chain's transactions, block by block, into one contract
+ *
+ * Each transaction becomes a TransferOp::transfer from its sender to its
+ * receiver for its amount (in 1 / AMOUNT_SCALE coin units), so senders
+ * need a balance in the contract first.
+ *
+ * @tparam EventSink Event sink of the target contract
+ */
+template <typename EventSink = NullEventSink>
+class ChainReplay {
+public:
+    ChainReplay(const Blockchain& chain, TokenContract<EventSink>& contract, ReplayOptions options = {})
+        : _chain(chain), _contract(contract), _options(options) {}
+
+    /**
+     * @brief Apply one block of the chain; blocks must come in index order
+     */
+    BlockReplayResult replayBlock(const Block& block) {
+        resolveAccounts();
+        _ops.clear();
+        _ops.reserve(static_cast<size_t>(block.transaction_count));
+        for (int i = 0; i < block.transaction_count; i++) {
+            _ops.push_back(TransferOp::transfer(_addresses[block.txs.senders[i]],
+                                                _addresses[block.txs.receivers[i]],
+                                                uint256_t(static_cast<uint64_t>(block.txs.amounts[i]))));
+        }
+
+        bool skipped = _options.atomicBlocks && !wholeBlockSucceeds();
+        size_t succeeded = skipped ? 0 : _contract.applyBatch(_ops).successCount();
+
+        _next = block.index + 1;
+        _summary.blocks++;
+        _summary.transfers += _ops.size();
+        _summary.succeeded += succeeded;
+        _summary.skippedBlocks += skipped;
+        return {block.index, _ops.size(), succeeded, skipped};
+    }
+
+    /**
+     * @brief Apply every block not replayed yet, up to the current tip
+     */
+    const ReplaySummary& replay() {
+        for (Block* block = blockchain_get(&_chain, _next); block != nullptr; block = block->next) {
+            replayBlock(*block);
+        }
+        return _summary;
+    }
+
+    /**
+     * @brief Index of the next block replay() will apply
+     */
+    int nextBlock() const {
+        return _next;
+    }
+
+    const ReplaySummary& summary() const {
+        return _summary;
+    }
+
+    /**
+     * @brief IngestConfig::on_block hook; user is a ChainReplay over the pipeline's target chain
+     *
+     * Runs on the pipeline's apply thread, which owns the chain while
+     * the pipeline runs, so the contract should not be used elsewhere
+     * until ingest_pipeline_finish returns.
+     */
+    static void onIngestedBlock(Blockchain* chain, const Block* block, void* user) {
+        (void)chain;
+        static_cast<ChainReplay*>(user)->replayBlock(*block);
+    }
+
+private:
+    const Blockchain& _chain;
+    TokenContract<EventSink>& _contract;
+    ReplayOptions _options;
+
+    // Address of every account ID, extended as the chain interns new names
+    std::vector<Address> _addresses;
+    std::vector<TransferOp> _ops;
+    // Balances touched by the block under a dry run, as it would leave them
+    FlatHashMap<Address, uint256_t, AddressHash> _pending;
+    int _next = 0;
+    ReplaySummary _summary;
+
+    /**
+     * @brief Whether every op in _ops would succeed, applied in order, without touching the contract
+     *
+     * Mirrors executeTransfer: the only failure is a sender short of
+     * the amount, counting what earlier ops in the block moved.
+     */
+    bool wholeBlockSucceeds() {
+        _pending.clear();
+        for (const TransferOp& op : _ops) {
+            auto [from, fromNew] = _pending.findOrInsert(op.from);
+            if (fromNew) {
+                *from = _contract.balanceOf(op.from);
+            }
+            if (*from < op.amount) {
+                return false;
+            }
+            *from -= op.amount;
+            // Looked up after the sender is done with, since inserting may move entries
+            auto [to, toNew] = _pending.findOrInsert(op.to);
+            if (toNew) {
+                *to = _contract.balanceOf(op.to);
+            }
+            *to += op.amount;
+        }
+        return true;
+    }
+
+    void resolveAccounts() {
+        for (uint32_t id = static_cast<uint32_t>(_addresses.size()); id < _chain.accounts.count; id++) {
+            _addresses.push_back(accountAddress(account_name(&_chain, id)));
+        }
+    }
+};
+
+/**
+ * @brief Replay independent tokens concurrently, one thread per replay
+ *
+ * Every replay must target a different contract. The calling thread
+ * takes the first replay itself.
+ */
+template <typename EventSink>
+void replayConcurrently(std::span<ChainReplay<EventSink>* const> replays) {
+    std::vector<std::thread> threads;
+    threads.reserve(replays.size());
+    for (size_t i = 1; i < replays.size(); i++) {
+        threads.emplace_back([replay = replays[i]] { replay->replay(); });
+    }
+    if (!replays.empty()) {
+        replays[0]->replay();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
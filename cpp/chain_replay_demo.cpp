@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Replaying C blockchain transactions into two token contracts at once
+ *
+ * Demonstrates:
+ * - ChainReplay feeding each block to TokenContract::applyBatch
+ * - Kept versus all-or-nothing blocks when senders run dry
+ * - Two independent tokens replayed on separate threads
+ * - Catching up incrementally as the chain grows
+ * - Journaling an all-or-nothing replay and recovering the same ledger from it
+ *
+ * Build: gcc -O2 -c ../c/blockchain.c ../c/sha256.c &&
+ *        g++ -std=c++20 -O2 -pthread chain_replay_demo.cpp blockchain.o sha256.o -o chain_replay_demo
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chain_replay.hpp"
+#include "token_contract.hpp"
+#include "token_journal.hpp"
+
+/**
+ * @brief Append a block of transfers between named accounts
+ */
+static Block* appendBlock(Blockchain& chain, std::initializer_list<std::pair<const char*, const char*>> transfers,
+                          int64_t amount) {
+    auto* block = static_cast<Block*>(arena_alloc(&chain.block_arena, sizeof(Block), alignof(Block)));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    std::memset(block, 0, sizeof(*block));
+    block->index = chain.tail->index + 1;
+    std::memcpy(block->previous_hash, chain.tail->current_hash, HASH_LENGTH);
+    block->timestamp = std::time(nullptr);
+
+    std::vector<Transaction> txs;
+    for (const auto& [from, to] : transfers) {
+        txs.push_back({account_intern(&chain, from), account_intern(&chain, to), amount, block->timestamp});
+    }
+    if (!add_transactions(&chain, block, txs.data(), txs.size())) {
+        return nullptr;
+    }
+    calculate_block_hash(block);
+    return blockchain_index_block(&chain, block) ? block : nullptr;
+}
+
+static void printSummary(const std::string& token, const ReplaySummary& s) {
+    std::cout << token << ": " << s.blocks << " blocks, " << s.succeeded << "/" << s.transfers
+              << " transfers applied, " << s.skippedBlocks << " blocks skipped" << std::endl;
+}
+
+template <typename EventSink>
+static void printBalances(const TokenContract<EventSink>& token, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        std::cout << "  " << name << " (" << accountAddress(name) << "): " << token.balanceOf(accountAddress(name))
+                  << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "=== Chain replay into TokenContract ===" << std::endl << std::endl;
+
+    // Two single-asset chains with the same traffic
+    Blockchain goldChain;
+    Blockchain silverChain;
+    for (Blockchain* chain : {&goldChain, &silverChain}) {
+        blockchain_init(chain);
+        create_genesis_block(chain);
+        for (int i = 0; i < 8; i++) {
+            appendBlock(*chain, {{"Alice", "Bob"}, {"Charlie", "Dave"}}, AMOUNT_SCALE);
+        }
+    }
+
+    // Alice can afford every block, Charlie only the first three
+    TokenContract<> gold("Gold", "GLD", 8, 1000 * AMOUNT_SCALE);
+    TokenContract<> silver("Silver", "SLV", 8, 1000 * AMOUNT_SCALE);
+    for (TokenContract<>* token : {&gold, &silver}) {
+        token->transfer(accountAddress("Alice"), 10 * AMOUNT_SCALE);
+        token->transfer(accountAddress("Charlie"), 3 * AMOUNT_SCALE);
+    }
+
+    ChainReplay<> goldReplay(goldChain, gold);
+    ChainReplay<> silverReplay(silverChain, silver, {.atomicBlocks = true});
+    ChainReplay<>* replays[] = {&goldReplay, &silverReplay};
+    replayConcurrently<NullEventSink>(replays);
+
+    std::cout << "\nKeeping the transfers that succeed:" << std::endl;
+    printSummary("GLD", goldReplay.summary());
+    printBalances(gold, {"Alice", "Bob", "Charlie", "Dave"});
+    std::cout << "\nSkipping any block with a failed transfer:" << std::endl;
+    printSummary("SLV", silverReplay.summary());
+    printBalances(silver, {"Alice", "Bob", "Charlie", "Dave"});
+
+    // New blocks are picked up from where the last replay stopped
+    appendBlock(goldChain, {{"Bob", "Erin"}}, 5 * AMOUNT_SCALE);
+    appendBlock(goldChain, {{"Erin", "Alice"}}, 2 * AMOUNT_SCALE);
+    goldReplay.replay();
+    std::cout << "\nAfter two more GLD blocks (next block " << goldReplay.nextBlock() << "):" << std::endl;
+    printSummary("GLD", goldReplay.summary());
+    printBalances(gold, {"Alice", "Bob", "Erin"});
+
+    // Skipped blocks emit nothing, so the journal replays to the same ledger
+    const char* journalPath = "chain_replay.journal";
+    std::remove(journalPath);
+    bool recovered = false;
+    {
+        TokenContract<JournalSink> journaled("Silver", "SLV", 8, 1000 * AMOUNT_SCALE);
+        journaled.events().open(journalPath);
+        journaled.transfer(accountAddress("Alice"), 10 * AMOUNT_SCALE);
+        journaled.transfer(accountAddress("Charlie"), 3 * AMOUNT_SCALE);
+        ChainReplay<JournalSink> journaledReplay(silverChain, journaled, {.atomicBlocks = true});
+        journaledReplay.replay();
+        journaled.events().commit();
+
+        TokenContract<> restored("Silver", "SLV", 8, 1000 * AMOUNT_SCALE);
+        uint64_t last = replayJournal(journalPath, restored, 0);
+        recovered = last == journaled.events().lastSequence();
+        for (const char* name : {"Alice", "Bob", "Charlie", "Dave"}) {
+            recovered = recovered && restored.balanceOf(accountAddress(name)) == journaled.balanceOf(accountAddress(name));
+        }
+        std::cout << "\nJournaled SLV replay: " << last << " records, recovered ledger "
+                  << (recovered ? "matches" : "DIFFERS") << std::endl;
+    }
+    std::remove(journalPath);
+
+    free_blockchain(&goldChain);
+    free_blockchain(&silverChain);
+    std::cout << "\nImplementation complete!" << std::endl;
+    return recovered ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief ERC-20 interface: compile-time concept and runtime adapter
+ *
+ * Demonstrates:
+ * - C++20 concept describing an ERC-20 token
+ * - Generic code templated on the concrete contract (inlinable calls)
+ * - Thin type-erased IERC20 adapter for runtime polymorphism
+ */
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+
+#include "address.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief Operations every ERC-20 token provides
+ *
+ * Batch and replay code should take `Erc20Token auto&` so calls bind
+ * directly to the concrete contract instead of going through a vtable.
+ */
+template <typename T>
+concept Erc20Token = requires(T& token, const T& view, const Address& a, const uint256_t& amount) {
+    { view.name() } -> std::convertible_to<std::string>;
+    { view.symbol() } -> std::convertible_to<std::string>;
+    { view.decimals() } -> std::same_as<uint8_t>;
+    { view.totalSupply() } -> std::same_as<uint256_t>;
+    { view.balanceOf(a) } -> std::same_as<uint256_t>;
+    { view.allowance(a, a) } -> std::same_as<uint256_t>;
+    { token.approve(a, amount) } -> std::same_as<bool>;
+    { token.transfer(a, amount) } -> std::same_as<bool>;
+    { token.transferFrom(a, a, amount) } -> std::same_as<bool>;
+};
+
+/**
+ * @brief ERC-20 Token Interface
+ */
+class IERC20 {
+public:
+    virtual std::string name() const = 0;
+    virtual std::string symbol() const = 0;
+    virtual uint8_t decimals() const = 0;
+    virtual uint256_t totalSupply() const = 0;
+    virtual uint256_t balanceOf(const Address& owner) const = 0;
+    virtual uint256_t allowance(const Address& owner, const Address& spender) const = 0;
+    virtual bool approve(const Address& spender, uint256_t amount) = 0;
+    virtual bool transfer(const Address& to, uint256_t amount) = 0;
+    virtual bool transferFrom(const Address& from, const Address& to, uint256_t amount) = 0;
+    virtual ~IERC20() {}
+};
+
+/**
+ * @brief IERC20 view over any Erc20Token, for callers needing runtime polymorphism
+ *
+ * Holds a reference; the token must outlive the adapter.
+ */
+template <Erc20Token Token>
+class Erc20Adapter final : public IERC20 {
+public:
+    explicit Erc20Adapter(Token& token) : _token(token) {}
+
+    std::string name() const override {
+        return _token.name();
+    }
+
+    std::string symbol() const override {
+        return _token.symbol();
+    }
+
+    uint8_t decimals() const override {
+        return _token.decimals();
+    }
+
+    uint256_t totalSupply() const override {
+        return _token.totalSupply();
+    }
+
+    uint256_t balanceOf(const Address& owner) const override {
+        return _token.balanceOf(owner);
+    }
+
+    uint256_t allowance(const Address& owner, const Address& spender) const override {
+        return _token.allowance(owner, spender);
+    }
+
+    bool approve(const Address& spender, uint256_t amount) override {
+        return _token.approve(spender, amount);
+    }
+
+    bool transfer(const Address& to, uint256_t amount) override {
+        return _token.transfer(to, amount);
+    }
+
+    bool transferFrom(const Address& from, const Address& to, uint256_t amount) override {
+        return _token.transferFrom(from, to, amount);
+    }
+
+private:
+    Token& _token;
+};
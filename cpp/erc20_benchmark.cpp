@@ -0,0 +1,699 @@
+/**
+ * @file
+ * @brief Microbenchmarks for the ERC-20 ledger hot path
+ *
+ * Demonstrates:
+ * - Google Benchmark fixtures parameterized by holder count
+ * - Lookup-pattern comparison for the transfer path
+ * - TokenContract operations under uniform and Zipfian account selection
+ * - ShardedBalanceStore seqlock reads racing a writer thread
+ * - Snapshot-backed contracts: mapped hits, filtered misses, copy-on-write first writes
+ * - Allocation counting (global operator new, plain and aligned) and peak RSS counters
+ *
+ * Build: g++ -std=c++20 -O2 erc20_benchmark.cpp -lbenchmark -lpthread -o erc20_benchmark
+ *
+ * Contract benchmarks run at 10^3..10^6 holders by default; set
+ * ERC20_BENCH_MAX_HOLDERS (up to 100000000) for larger ledgers. Every
+ * benchmark reports op_time (per operation, also for batches),
+ * allocs/op and rss_MB (resident size once the ledger is built).
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "address.hpp"
+#include "flat_hash_map.hpp"
+#include "parallel_executor.hpp"
+#include "sharded_balance_store.hpp"
+#include "token_contract.hpp"
+#include "token_snapshot.hpp"
+#include "transfer_batch.hpp"
+#include "uint256.hpp"
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// FlatHashMap tables and other over-aligned types come through here
+void* operator new(size_t size, std::align_val_t align) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment = static_cast<size_t>(align);
+    size_t rounded = (size + alignment - 1) & ~(alignment - 1);
+    if (void* p = std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC cannot see that the replaced operator new also uses malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#pragma GCC diagnostic pop
+
+using BalanceMap = FlatHashMap<Address, uint256_t, AddressHash>;
+
+/**
+ * @brief Deterministic address for holder i; never the contract owner (0x0)
+ */
+static Address holderAddress(uint64_t i) {
+    Address a{};
+    a.bytes[0] = 0x01;
+    std::memcpy(a.bytes + Address::kSize - sizeof(i), &i, sizeof(i));
+    return a;
+}
+
+/**
+ * @brief Address guaranteed not to hold a balance
+ */
+static Address unknownAddress(uint64_t i) {
+    Address a = holderAddress(i);
+    a.bytes[0] = 0x02;
+    return a;
+}
+
+/**
+ * @brief Balance table with n funded holders and a shuffled transfer list
+ */
+struct TransferWorkload {
+    BalanceMap balances;
+    std::vector<std::pair<Address, Address>> pairs;
+
+    explicit TransferWorkload(size_t holders) {
+        balances.reserve(holders);
+        for (size_t i = 0; i < holders; i++) {
+            balances[holderAddress(i)] = 1000000;
+        }
+        std::mt19937_64 rng(42);
+        pairs.resize(4096);
+        for (auto& p : pairs) {
+            p = {holderAddress(rng() % holders), holderAddress(rng() % holders)};
+        }
+    }
+};
+
+/**
+ * @brief The original transfer: balanceOf twice, balanceOf(to), two operator[] writes
+ */
+static void BM_TransferRepeatedLookups(benchmark::State& state) {
+    TransferWorkload w(static_cast<size_t>(state.range(0)));
+    auto balanceOf = [&](const Address& a) {
+        const uint256_t* b = w.balances.find(a);
+        return b != nullptr ? *b : uint256_t(0);
+    };
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [from, to] = w.pairs[i++ & (w.pairs.size() - 1)];
+        uint256_t amount = 1;
+        if (balanceOf(from) < amount) {
+            continue;
+        }
+        w.balances[from] = balanceOf(from) - amount;
+        w.balances[to] = balanceOf(to) + amount;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Entry-handle transfer: one probe for the sender, one for the recipient
+ */
+static void BM_TransferEntryHandles(benchmark::State& state) {
+    TransferWorkload w(static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [from, to] = w.pairs[i++ & (w.pairs.size() - 1)];
+        uint256_t amount = 1;
+        uint256_t* fromBalance = w.balances.find(from);
+        if (fromBalance == nullptr || *fromBalance < amount) {
+            continue;
+        }
+        *fromBalance -= amount;
+        *w.balances.findOrInsert(to).first += amount;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TransferRepeatedLookups)->RangeMultiplier(100)->Range(1000, 10000000);
+BENCHMARK(BM_TransferEntryHandles)->RangeMultiplier(100)->Range(1000, 10000000);
+
+/**
+ * @brief Zipfian ranks in [0, n), YCSB-style (Gray et al.), theta < 1
+ *
+ * zeta(n) uses the Euler-Maclaurin approximation so setup stays O(1)
+ * even for 10^8 accounts.
+ */
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(uint64_t n, double theta = 0.99) : _n(n) {
+        double zeta2 = 1.0 + std::pow(0.5, theta);
+        _zetaN = zeta(static_cast<double>(n), theta);
+        _alpha = 1.0 / (1.0 - theta);
+        _eta = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta2 / _zetaN);
+        _half = 1.0 + std::pow(0.5, theta);
+    }
+
+    template <typename Rng>
+    uint64_t operator()(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * _zetaN;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < _half) {
+            return 1;
+        }
+        auto rank = static_cast<uint64_t>(static_cast<double>(_n) * std::pow(_eta * u - _eta + 1.0, _alpha));
+        return rank < _n ? rank : _n - 1;
+    }
+
+private:
+    static double zeta(double n, double s) {
+        return (std::pow(n, 1.0 - s) - 1.0) / (1.0 - s) + 0.5 * (1.0 + std::pow(n, -s)) +
+               s / 12.0 * (1.0 - std::pow(n, -s - 1.0));
+    }
+
+    uint64_t _n;
+    double _zetaN;
+    double _alpha;
+    double _eta;
+    double _half;
+};
+
+constexpr uint64_t kInitialBalance = 1000000;
+constexpr size_t kAccessCount = size_t{1} << 16;
+constexpr size_t kBatchSize = 256;
+
+/**
+ * @brief Contract with the given number of funded holders
+ *
+ * Built once and shared by every benchmark with the same holder count,
+ * since a 10^8-holder ledger takes a while to fill. Benchmarks only move
+ * single units around, so the state stays representative.
+ */
+static TokenContract<>& ledger(size_t holders) {
+    static std::unique_ptr<TokenContract<>> token;
+    static size_t built = 0;
+    if (token != nullptr && built == holders) {
+        return *token;
+    }
+    token.reset();
+    // The owner keeps 2^64 for the transfer/approve benchmarks to spend
+    uint256_t supply = uint256_t::fromLimbs(0, 1, 0, 0) + uint256_t(kInitialBalance * holders);
+    token = std::make_unique<TokenContract<>>("Bench", "BNC", 18, supply);
+    token->reserve(holders + 1);
+    std::vector<TransferOp> ops;
+    ops.reserve(kAccessCount);
+    for (size_t i = 0; i < holders; i += ops.size()) {
+        ops.clear();
+        for (size_t j = i; j < holders && ops.size() < kAccessCount; j++) {
+            ops.push_back(TransferOp::transfer(Address::zero(), holderAddress(j), kInitialBalance));
+        }
+        token->applyBatch(ops);
+    }
+    built = holders;
+    return *token;
+}
+
+/**
+ * @brief Pre-drawn holder indices so the timed loop does no sampling
+ */
+static std::vector<uint64_t> accessPattern(size_t holders, bool zipf, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> picks(kAccessCount);
+    if (zipf) {
+        ZipfianGenerator gen(holders);
+        for (auto& p : picks) {
+            p = gen(rng);
+        }
+    } else {
+        for (auto& p : picks) {
+            p = rng() % holders;
+        }
+    }
+    return picks;
+}
+
+static std::vector<Address> accessAddresses(size_t holders, bool zipf, uint64_t seed) {
+    std::vector<Address> addresses;
+    addresses.reserve(kAccessCount);
+    for (uint64_t i : accessPattern(holders, zipf, seed)) {
+        addresses.push_back(holderAddress(i));
+    }
+    return addresses;
+}
+
+/**
+ * @brief Current resident set size (Linux /proc/self/statm)
+ */
+static double rssMegabytes() {
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%lu %lu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+    }
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+/**
+ * @brief Measures allocations made by the timed loop and reports the common counters
+ */
+class OpCounters {
+public:
+    OpCounters() : _start(g_allocations.load(std::memory_order_relaxed)) {}
+
+    void report(benchmark::State& state, int64_t opsPerIteration = 1) {
+        double ops = static_cast<double>(state.iterations() * opsPerIteration);
+        double allocs = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - _start);
+        state.counters["op_time"] = benchmark::Counter(ops, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        // Threaded runs sum counters over threads; these two are process-wide
+        state.counters["allocs/op"] = benchmark::Counter(ops > 0 ? allocs / ops : 0.0, benchmark::Counter::kAvgThreads);
+        state.counters["rss_MB"] = benchmark::Counter(rssMegabytes(), benchmark::Counter::kAvgThreads);
+        state.SetItemsProcessed(static_cast<int64_t>(ops));
+    }
+
+private:
+    uint64_t _start;
+};
+
+static size_t holdersArg(const benchmark::State& state) {
+    return static_cast<size_t>(state.range(0));
+}
+
+static bool zipfArg(const benchmark::State& state) {
+    return state.range(1) != 0;
+}
+
+static void BM_BalanceOfHit(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<Address> owners = accessAddresses(holdersArg(state), zipfArg(state), 1);
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token.balanceOf(owners[i++ & (kAccessCount - 1)]));
+    }
+    counters.report(state);
+}
+
+static void BM_BalanceOfMiss(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<Address> owners;
+    owners.reserve(kAccessCount);
+    for (uint64_t i : accessPattern(holdersArg(state), zipfArg(state), 2)) {
+        owners.push_back(unknownAddress(i));
+    }
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token.balanceOf(owners[i++ & (kAccessCount - 1)]));
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief transfer() as msgSender (the contract owner) to a sampled holder
+ */
+static void BM_Transfer(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<Address> recipients = accessAddresses(holdersArg(state), zipfArg(state), 3);
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token.transfer(recipients[i++ & (kAccessCount - 1)], 1));
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief approve() for a sampled spender (overwrites after the first pass)
+ */
+static void BM_Approve(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<Address> spenders = accessAddresses(holdersArg(state), zipfArg(state), 4);
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token.approve(spenders[i & (kAccessCount - 1)], i));
+        i++;
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief Holder-to-holder transfers, kBatchSize per applyBatch call
+ */
+static std::vector<TransferOp> transferOps(size_t holders, bool zipf) {
+    std::vector<uint64_t> from = accessPattern(holders, zipf, 5);
+    std::vector<uint64_t> to = accessPattern(holders, zipf, 6);
+    std::vector<TransferOp> ops;
+    ops.reserve(kAccessCount);
+    for (size_t i = 0; i < kAccessCount; i++) {
+        ops.push_back(TransferOp::transfer(holderAddress(from[i]), holderAddress(to[i]), 1));
+    }
+    return ops;
+}
+
+/**
+ * @brief transferFrom by sampled spenders out of allowances granted by the owner
+ *
+ * approve() always acts as msgSender, so the contract owner is the one
+ * account that can grant allowances here.
+ */
+static std::vector<TransferOp> transferFromOps(TokenContract<>& token, size_t holders, bool zipf) {
+    std::vector<uint64_t> spenders = accessPattern(holders, zipf, 7);
+    std::vector<uint64_t> to = accessPattern(holders, zipf, 8);
+    std::vector<TransferOp> ops;
+    ops.reserve(kAccessCount);
+    for (size_t i = 0; i < kAccessCount; i++) {
+        Address spender = holderAddress(spenders[i]);
+        ops.push_back(TransferOp::transferFrom(spender, Address::zero(), holderAddress(to[i]), 1));
+    }
+    // Generous enough for any benchmark run; repeated spenders just re-approve
+    for (const TransferOp& op : ops) {
+        token.approve(op.spender, uint256_t(kInitialBalance));
+    }
+    return ops;
+}
+
+template <typename Execute>
+static void runBatches(benchmark::State& state, const std::vector<TransferOp>& ops, Execute&& execute) {
+    size_t offset = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        BatchStatus status = execute(std::span<const TransferOp>(ops.data() + offset, kBatchSize));
+        benchmark::DoNotOptimize(status);
+        offset = (offset + kBatchSize) & (kAccessCount - 1);
+    }
+    counters.report(state, kBatchSize);
+}
+
+static void BM_ApplyBatchTransfer(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<TransferOp> ops = transferOps(holdersArg(state), zipfArg(state));
+    runBatches(state, ops, [&](std::span<const TransferOp> batch) { return token.applyBatch(batch); });
+}
+
+static void BM_ApplyBatchTransferFrom(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<TransferOp> ops = transferFromOps(token, holdersArg(state), zipfArg(state));
+    runBatches(state, ops, [&](std::span<const TransferOp> batch) { return token.applyBatch(batch); });
+}
+
+static void BM_ParallelExecuteTransfer(benchmark::State& state) {
+    TokenContract<>& token = ledger(holdersArg(state));
+    std::vector<TransferOp> ops = transferOps(holdersArg(state), zipfArg(state));
+    ParallelExecutor<NullEventSink> executor;
+    runBatches(state, ops, [&](std::span<const TransferOp> batch) { return executor.execute(token, batch); });
+}
+
+/**
+ * @brief ledger(holders) written to a snapshot and mapped back
+ *
+ * The file is unlinked as soon as it is mapped; the mapping keeps it
+ * alive. nullptr if it could not be written.
+ */
+static std::shared_ptr<const MappedSnapshot> ledgerSnapshot(size_t holders) {
+    static std::shared_ptr<const MappedSnapshot> snapshot;
+    static size_t built = 0;
+    if (snapshot != nullptr && built == holders) {
+        return snapshot;
+    }
+    snapshot.reset();
+    std::string path = "erc20_benchmark." + std::to_string(getpid()) + ".snap";
+    if (!writeSnapshot(ledger(holders), path)) {
+        return nullptr;
+    }
+    snapshot = MappedSnapshot::open(path);
+    std::remove(path.c_str());
+    built = holders;
+    return snapshot;
+}
+
+/**
+ * @brief Read-only contract over ledgerSnapshot(holders); nothing is copied into its tables
+ */
+static TokenContract<>* snapshotLedger(size_t holders) {
+    static std::unique_ptr<TokenContract<>> token;
+    static size_t built = 0;
+    if (token != nullptr && built == holders) {
+        return token.get();
+    }
+    token.reset();
+    if (std::shared_ptr<const MappedSnapshot> snapshot = ledgerSnapshot(holders)) {
+        token = std::make_unique<TokenContract<>>(std::move(snapshot));
+        built = holders;
+    }
+    return token.get();
+}
+
+static void BM_SnapshotBalanceOfHit(benchmark::State& state) {
+    TokenContract<>* token = snapshotLedger(holdersArg(state));
+    if (token == nullptr) {
+        state.SkipWithError("could not write snapshot");
+        return;
+    }
+    std::vector<Address> owners = accessAddresses(holdersArg(state), zipfArg(state), 1);
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token->balanceOf(owners[i++ & (kAccessCount - 1)]));
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief Unknown accounts, mostly turned away by the stored balance filter
+ */
+static void BM_SnapshotBalanceOfMiss(benchmark::State& state) {
+    TokenContract<>* token = snapshotLedger(holdersArg(state));
+    if (token == nullptr) {
+        state.SkipWithError("could not write snapshot");
+        return;
+    }
+    std::vector<Address> owners;
+    owners.reserve(kAccessCount);
+    for (uint64_t i : accessPattern(holdersArg(state), zipfArg(state), 2)) {
+        owners.push_back(unknownAddress(i));
+    }
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(token->balanceOf(owners[i++ & (kAccessCount - 1)]));
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief First transfer to each snapshot holder, copying its record into the tables
+ *
+ * Walks the holders in order and reopens the contract on the snapshot
+ * (untimed) once every one of them has been written.
+ */
+static void BM_SnapshotFirstWrite(benchmark::State& state) {
+    size_t holders = holdersArg(state);
+    std::shared_ptr<const MappedSnapshot> snapshot = ledgerSnapshot(holders);
+    if (snapshot == nullptr) {
+        state.SkipWithError("could not write snapshot");
+        return;
+    }
+    auto token = std::make_unique<TokenContract<>>(snapshot);
+    size_t next = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        if (next == holders) {
+            state.PauseTiming();
+            token = std::make_unique<TokenContract<>>(snapshot);
+            next = 0;
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(token->transfer(holderAddress(next++), 1));
+    }
+    counters.report(state);
+}
+
+/**
+ * @brief Sharded store with the given number of funded holders, shared by benchmark threads
+ */
+static ShardedBalanceStore<>& shardedStore(size_t holders) {
+    static std::mutex mutex;
+    static std::unique_ptr<ShardedBalanceStore<>> store;
+    static size_t built = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (store == nullptr || built != holders) {
+        store.reset();
+        store = std::make_unique<ShardedBalanceStore<>>();
+        for (size_t i = 0; i < holders; i++) {
+            store->credit(holderAddress(i), uint256_t(kInitialBalance));
+        }
+        built = holders;
+    }
+    return *store;
+}
+
+/**
+ * @brief Holder-to-holder unit transfers on a background thread until stopped
+ */
+class ShardedWriter {
+public:
+    ShardedWriter(ShardedBalanceStore<>& store, size_t holders) : _ops(transferOps(holders, false)) {
+        _thread = std::thread([this, &store] {
+            uint64_t n = 0;
+            while (!_stop.load(std::memory_order_relaxed)) {
+                const TransferOp& op = _ops[n++ & (kAccessCount - 1)];
+                store.transfer(op.from, op.to, op.amount);
+            }
+            _transfers = n;
+        });
+    }
+
+    /**
+     * @brief Join the writer; returns the number of transfers it made
+     */
+    uint64_t stop() {
+        _stop.store(true, std::memory_order_relaxed);
+        _thread.join();
+        return _transfers;
+    }
+
+private:
+    std::vector<TransferOp> _ops;
+    std::atomic<bool> _stop{false};
+    uint64_t _transfers = 0;
+    std::thread _thread;
+};
+
+/**
+ * @brief balanceOf on every benchmark thread, optionally racing one writer thread
+ */
+static void BM_ShardedBalanceOf(benchmark::State& state) {
+    size_t holders = holdersArg(state);
+    ShardedBalanceStore<>& store = shardedStore(holders);
+    std::unique_ptr<ShardedWriter> writer;
+    if (state.thread_index() == 0 && state.range(1) != 0) {
+        writer = std::make_unique<ShardedWriter>(store, holders);
+    }
+    std::vector<Address> owners = accessAddresses(holders, false, 10 + static_cast<uint64_t>(state.thread_index()));
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.balanceOf(owners[i++ & (kAccessCount - 1)]));
+    }
+    counters.report(state);
+    if (writer != nullptr) {
+        state.counters["writes"] = static_cast<double>(writer->stop());
+    }
+}
+
+/**
+ * @brief Holder-to-holder transfers from every benchmark thread, contending on shard locks
+ */
+static void BM_ShardedTransfer(benchmark::State& state) {
+    size_t holders = holdersArg(state);
+    ShardedBalanceStore<>& store = shardedStore(holders);
+    std::vector<TransferOp> ops = transferOps(holders, false);
+    std::rotate(ops.begin(), ops.begin() + state.thread_index() * 4096, ops.end());
+    size_t i = 0;
+    OpCounters counters;
+    for (auto _ : state) {
+        const TransferOp& op = ops[i++ & (kAccessCount - 1)];
+        benchmark::DoNotOptimize(store.transfer(op.from, op.to, op.amount));
+    }
+    counters.report(state);
+}
+
+BENCHMARK(BM_ShardedBalanceOf)
+    ->ArgsProduct({{1000, 1000000}, {0, 1}})
+    ->ArgNames({"holders", "writer"})
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+BENCHMARK(BM_ShardedTransfer)->Arg(1000)->Arg(1000000)->ArgName("holders")->ThreadRange(1, 4)->UseRealTime();
+
+/**
+ * @brief Register the contract benchmarks for 10^3 .. max holders, uniform and Zipfian
+ *
+ * Grouped by holder count so each ledger is built once.
+ */
+static void registerContractBenchmarks(size_t maxHolders) {
+    struct Case {
+        const char* name;
+        void (*fn)(benchmark::State&);
+    };
+    const Case cases[] = {
+        {"BM_BalanceOfHit", BM_BalanceOfHit},
+        {"BM_BalanceOfMiss", BM_BalanceOfMiss},
+        {"BM_Transfer", BM_Transfer},
+        {"BM_Approve", BM_Approve},
+        {"BM_ApplyBatchTransfer", BM_ApplyBatchTransfer},
+        {"BM_ApplyBatchTransferFrom", BM_ApplyBatchTransferFrom},
+        {"BM_ParallelExecuteTransfer", BM_ParallelExecuteTransfer},
+        {"BM_SnapshotBalanceOfHit", BM_SnapshotBalanceOfHit},
+        {"BM_SnapshotBalanceOfMiss", BM_SnapshotBalanceOfMiss},
+    };
+    for (size_t holders = 1000; holders <= maxHolders; holders *= 10) {
+        for (const Case& c : cases) {
+            for (int zipf = 0; zipf <= 1; zipf++) {
+                benchmark::RegisterBenchmark(c.name, c.fn)
+                    ->Args({static_cast<int64_t>(holders), zipf})
+                    ->ArgNames({"holders", "zipf"});
+            }
+        }
+        benchmark::RegisterBenchmark("BM_SnapshotFirstWrite", BM_SnapshotFirstWrite)
+            ->Arg(static_cast<int64_t>(holders))
+            ->ArgName("holders");
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxHolders = 1000000;
+    if (const char* env = std::getenv("ERC20_BENCH_MAX_HOLDERS")) {
+        maxHolders = std::strtoull(env, nullptr, 10);
+    }
+    registerContractBenchmarks(maxHolders);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
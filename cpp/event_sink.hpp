@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Structured Transfer/Approval events and sink policies
+ *
+ * Demonstrates:
+ * - Sink as a compile-time policy (no virtual dispatch)
+ * - No-op default that optimizes away entirely
+ * - Lock-free single-producer/single-consumer ring buffer sink
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "address.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief ERC-20 Transfer(from, to, value)
+ */
+struct TransferEvent {
+    Address from;
+    Address to;
+    uint256_t value;
+};
+
+/**
+ * @brief ERC-20 Approval(owner, spender, value)
+ */
+struct ApprovalEvent {
+    Address owner;
+    Address spender;
+    uint256_t value;
+};
+
+/**
+ * @brief Sink that discards every event (the production default)
+ */
+struct NullEventSink {
+    void onTransfer(const TransferEvent&) {}
+    void onApproval(const ApprovalEvent&) {}
+};
+
+/**
+ * @brief Either event, as stored in a ring buffer slot
+ *
+ * For approvals `from`/`to` hold owner/spender.
+ */
+struct TokenEvent {
+    enum class Kind : uint8_t { Transfer, Approval };
+
+    Kind kind;
+    Address from;
+    Address to;
+    uint256_t value;
+};
+
+/**
+ * @brief Lock-free SPSC ring buffer sink for asynchronous logging
+ *
+ * The contract's thread is the only producer; one consumer thread drains
+ * with pop(). The producer never blocks: when the ring is full the event
+ * is dropped and counted.
+ *
+ * @tparam Capacity Number of slots, a power of two
+ */
+template <size_t Capacity = 4096>
+class SpscRingSink {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    void onTransfer(const TransferEvent& e) {
+        push({TokenEvent::Kind::Transfer, e.from, e.to, e.value});
+    }
+
+    void onApproval(const ApprovalEvent& e) {
+        push({TokenEvent::Kind::Approval, e.owner, e.spender, e.value});
+    }
+
+    /**
+     * @brief Consumer side: take the oldest event
+     * @return false if the ring is empty
+     */
+    bool pop(TokenEvent& out) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = _slots[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Events lost because the consumer fell behind
+     */
+    uint64_t dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    void push(const TokenEvent& e) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tailCache == Capacity) {
+            _tailCache = _tail.load(std::memory_order_acquire);
+            if (head - _tailCache == Capacity) {
+                _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        _slots[head & (Capacity - 1)] = e;
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> _head{0};
+    size_t _tailCache = 0;
+    std::atomic<uint64_t> _dropped{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+    alignas(64) TokenEvent _slots[Capacity];
+};
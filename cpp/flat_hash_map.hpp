@@ -0,0 +1,469 @@
+/**
+ * @file
+ * @brief Open-addressing hash map with SwissTable-style control bytes
+ *
+ * Demonstrates:
+ * - One control byte per slot (empty / deleted / 7-bit hash tag)
+ * - 16-slot groups matched with a single SSE2 compare
+ * - Triangular probing over groups, 7/8 maximum load factor
+ * - Flat slot array: no per-entry allocation, no pointer chasing
+ *
+ * Keys and values must be trivially copyable; the ledger only stores
+ * addresses, address pairs and fixed-width integers.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace detail {
+
+/**
+ * @brief Control byte values; full slots hold the hash tag (0..127)
+ */
+constexpr int8_t kCtrlEmpty = -128;
+constexpr int8_t kCtrlDeleted = -2;
+constexpr size_t kGroupWidth = 16;
+
+/**
+ * @brief View over the 16 control bytes of one group
+ */
+struct CtrlGroup {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128i ctrl;
+
+    explicit CtrlGroup(const int8_t* p) : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    /**
+     * @brief Bit i set when slot i carries the given tag
+     */
+    uint32_t match(int8_t tag) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag))));
+    }
+
+    uint32_t matchEmpty() const {
+        return match(kCtrlEmpty);
+    }
+
+    /**
+     * @brief Bit i set when slot i is empty or deleted (sign bit set)
+     */
+    uint32_t matchAvailable() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+    }
+#else
+    const int8_t* ctrl;
+
+    explicit CtrlGroup(const int8_t* p) : ctrl(p) {}
+
+    uint32_t match(int8_t tag) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; i++) {
+            mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+        }
+        return mask;
+    }
+
+    uint32_t matchEmpty() const {
+        return match(kCtrlEmpty);
+    }
+
+    uint32_t matchAvailable() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupWidth; i++) {
+            mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+        }
+        return mask;
+    }
+#endif
+};
+
+} // namespace detail
+
+/**
+ * @brief Flat open-addressing map for trivially copyable keys and values
+ *
+ * Entries expose `first`/`second` like std::map so call sites iterate the
+ * same way. Pointers and iterators are invalidated by any insertion that
+ * grows the table.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class FlatHashMap {
+    static_assert(std::is_trivially_copyable_v<K>, "FlatHashMap keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<V>, "FlatHashMap values must be trivially copyable");
+
+public:
+    struct Entry {
+        K first;
+        V second;
+    };
+
+    template <bool Const>
+    class Iterator {
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        using Ref = std::conditional_t<Const, const Entry&, Entry&>;
+
+    public:
+        Iterator(Map* map, size_t index) : _map(map), _index(index) {
+            skipToFull();
+        }
+
+        Ref operator*() const {
+            return _map->_slots[_index];
+        }
+
+        auto* operator->() const {
+            return &_map->_slots[_index];
+        }
+
+        Iterator& operator++() {
+            _index++;
+            skipToFull();
+            return *this;
+        }
+
+        bool operator==(const Iterator& o) const {
+            return _index == o._index;
+        }
+
+        /**
+         * @brief Slot position, usable as a resume point for iteratorAt
+         */
+        size_t slot() const {
+            return _index;
+        }
+
+    private:
+        void skipToFull() {
+            while (_index < _map->_capacity && _map->_ctrl[_index] < 0) {
+                _index++;
+            }
+        }
+
+        Map* _map;
+        size_t _index;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap& o) {
+        *this = o;
+    }
+
+    FlatHashMap(FlatHashMap&& o) noexcept {
+        swap(o);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& o) {
+        if (this != &o) {
+            FlatHashMap copy;
+            copy.allocate(o._capacity);
+            if (o._capacity != 0) {
+                std::memcpy(copy._ctrl, o._ctrl, o._capacity);
+                std::memcpy(static_cast<void*>(copy._slots), o._slots, o._capacity * sizeof(Entry));
+            }
+            copy._size = o._size;
+            copy._growthLeft = o._growthLeft;
+            swap(copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& o) noexcept {
+        FlatHashMap tmp(std::move(o));
+        swap(tmp);
+        return *this;
+    }
+
+    ~FlatHashMap() {
+        deallocate();
+    }
+
+    void swap(FlatHashMap& o) noexcept {
+        std::swap(_ctrl, o._ctrl);
+        std::swap(_slots, o._slots);
+        std::swap(_capacity, o._capacity);
+        std::swap(_size, o._size);
+        std::swap(_growthLeft, o._growthLeft);
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, _capacity);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, _capacity);
+    }
+
+    /**
+     * @brief First entry at slot position >= slot (end() past the last)
+     *
+     * Positions stay meaningful until the table is rehashed.
+     */
+    const_iterator iteratorAt(size_t slot) const {
+        return const_iterator(this, std::min(slot, _capacity));
+    }
+
+    /**
+     * @brief Size the table so n entries fit without rehashing
+     */
+    void reserve(size_t n) {
+        size_t needed = capacityFor(n);
+        if (needed > _capacity) {
+            rehash(needed);
+        }
+    }
+
+    /**
+     * @brief Pointer to the value for key, or nullptr
+     */
+    V* find(const K& key) {
+        size_t index = findIndex(key, Hash{}(key));
+        return index == kNotFound ? nullptr : &_slots[index].second;
+    }
+
+    const V* find(const K& key) const {
+        size_t index = findIndex(key, Hash{}(key));
+        return index == kNotFound ? nullptr : &_slots[index].second;
+    }
+
+    bool contains(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    /**
+     * @brief Start loading the control group key's probe begins in
+     *
+     * First half of a two-stage software prefetch: issue this a few
+     * operations ahead, then prefetchEntry once the group is cached.
+     */
+    void prefetchGroup(const K& key) const {
+        if (_capacity != 0) {
+            __builtin_prefetch(_ctrl + homeGroup(Hash{}(key)) * detail::kGroupWidth);
+        }
+    }
+
+    /**
+     * @brief Start loading the slots whose tag matches key in its home group
+     */
+    void prefetchEntry(const K& key) const {
+        if (_capacity == 0) {
+            return;
+        }
+        size_t hash = Hash{}(key);
+        size_t base = homeGroup(hash) * detail::kGroupWidth;
+        for (uint32_t m = detail::CtrlGroup(_ctrl + base).match(tagOf(hash)); m != 0; m &= m - 1) {
+            __builtin_prefetch(&_slots[base + static_cast<size_t>(__builtin_ctz(m))]);
+        }
+    }
+
+    /**
+     * @brief Value for key, value-initialized on first access
+     */
+    V& operator[](const K& key) {
+        return *findOrInsert(key).first;
+    }
+
+    /**
+     * @brief Locate key, inserting a value-initialized entry if missing
+     *
+     * The returned pointer is an entry handle: callers can check and then
+     * update the value without probing again, as long as nothing else is
+     * inserted in between.
+     *
+     * @return Pointer to the value and whether it was inserted
+     */
+    std::pair<V*, bool> findOrInsert(const K& key) {
+        size_t hash = Hash{}(key);
+        size_t index = findIndex(key, hash);
+        if (index != kNotFound) {
+            return {&_slots[index].second, false};
+        }
+
+        index = _capacity == 0 ? kNotFound : findAvailable(hash);
+        if (index == kNotFound || (_ctrl[index] == detail::kCtrlEmpty && _growthLeft == 0)) {
+            // Grow, or just purge tombstones when they are what filled us up
+            rehash(_size + 1 > maxLoad(_capacity) / 2 ? capacityFor(_size * 2 + 1) : _capacity);
+            index = findAvailable(hash);
+        }
+
+        if (_ctrl[index] == detail::kCtrlEmpty) {
+            _growthLeft--;
+        }
+        _ctrl[index] = tagOf(hash);
+        new (&_slots[index]) Entry{key, V{}};
+        _size++;
+        return {&_slots[index].second, true};
+    }
+
+    /**
+     * @brief Remove key
+     * @return true if it was present
+     */
+    bool erase(const K& key) {
+        size_t index = findIndex(key, Hash{}(key));
+        if (index == kNotFound) {
+            return false;
+        }
+        // A group that still has an empty slot terminates every probe that
+        // reaches it, so the slot can go straight back to empty.
+        size_t groupStart = index & ~(detail::kGroupWidth - 1);
+        if (detail::CtrlGroup(_ctrl + groupStart).matchEmpty() != 0) {
+            _ctrl[index] = detail::kCtrlEmpty;
+            _growthLeft++;
+        } else {
+            _ctrl[index] = detail::kCtrlDeleted;
+        }
+        _size--;
+        return true;
+    }
+
+    void clear() {
+        if (_capacity != 0) {
+            std::memset(_ctrl, detail::kCtrlEmpty, _capacity);
+        }
+        _size = 0;
+        _growthLeft = maxLoad(_capacity);
+    }
+
+private:
+    static constexpr size_t kNotFound = ~size_t{0};
+
+    static int8_t tagOf(size_t hash) {
+        return static_cast<int8_t>(hash & 0x7f);
+    }
+
+    size_t homeGroup(size_t hash) const {
+        return (hash >> 7) & (_capacity / detail::kGroupWidth - 1);
+    }
+
+    static size_t maxLoad(size_t capacity) {
+        return capacity - capacity / 8;
+    }
+
+    static size_t capacityFor(size_t n) {
+        size_t capacity = detail::kGroupWidth;
+        while (maxLoad(capacity) < n) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    size_t findIndex(const K& key, size_t hash) const {
+        if (_capacity == 0) {
+            return kNotFound;
+        }
+        size_t groupMask = _capacity / detail::kGroupWidth - 1;
+        size_t group = (hash >> 7) & groupMask;
+        int8_t tag = tagOf(hash);
+        for (size_t step = 1;; step++) {
+            size_t base = group * detail::kGroupWidth;
+            detail::CtrlGroup g(_ctrl + base);
+            for (uint32_t m = g.match(tag); m != 0; m &= m - 1) {
+                size_t index = base + static_cast<size_t>(__builtin_ctz(m));
+                if (Eq{}(_slots[index].first, key)) {
+                    return index;
+                }
+            }
+            if (g.matchEmpty() != 0) {
+                return kNotFound;
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    /**
+     * @brief First empty or deleted slot on the probe sequence for hash
+     */
+    size_t findAvailable(size_t hash) const {
+        size_t groupMask = _capacity / detail::kGroupWidth - 1;
+        size_t group = (hash >> 7) & groupMask;
+        for (size_t step = 1;; step++) {
+            size_t base = group * detail::kGroupWidth;
+            uint32_t m = detail::CtrlGroup(_ctrl + base).matchAvailable();
+            if (m != 0) {
+                return base + static_cast<size_t>(__builtin_ctz(m));
+            }
+            group = (group + step) & groupMask;
+        }
+    }
+
+    void allocate(size_t capacity) {
+        _capacity = capacity;
+        _size = 0;
+        _growthLeft = maxLoad(capacity);
+        if (capacity == 0) {
+            return;
+        }
+        _ctrl = static_cast<int8_t*>(::operator new(capacity, std::align_val_t{detail::kGroupWidth}));
+        std::memset(_ctrl, detail::kCtrlEmpty, capacity);
+        _slots = static_cast<Entry*>(::operator new(capacity * sizeof(Entry), std::align_val_t{alignof(Entry)}));
+    }
+
+    void deallocate() {
+        if (_ctrl != nullptr) {
+            ::operator delete(_ctrl, std::align_val_t{detail::kGroupWidth});
+            ::operator delete(_slots, std::align_val_t{alignof(Entry)});
+        }
+        _ctrl = nullptr;
+        _slots = nullptr;
+        _capacity = 0;
+    }
+
+    void rehash(size_t newCapacity) {
+        FlatHashMap old;
+        swap(old);
+        allocate(newCapacity);
+        for (size_t i = 0; i < old._capacity; i++) {
+            if (old._ctrl[i] >= 0) {
+                const Entry& e = old._slots[i];
+                size_t hash = Hash{}(e.first);
+                size_t index = findAvailable(hash);
+                _ctrl[index] = tagOf(hash);
+                new (&_slots[index]) Entry(e);
+            }
+        }
+        _size = old._size;
+        _growthLeft = maxLoad(newCapacity) - _size;
+    }
+
+    int8_t* _ctrl = nullptr;
+    Entry* _slots = nullptr;
+    size_t _capacity = 0;
+    size_t _size = 0;
+    size_t _growthLeft = 0;
+};
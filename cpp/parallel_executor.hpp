@@ -0,0 +1,265 @@
+/**
+ * @file
+ * @brief Optimistic parallel execution of transfer batches
+ *
+ * Demonstrates:
+ * - Speculative execution against the pre-batch state on a worker pool
+ * - Recorded read sets validated in block order
+ * - Re-execution of conflicting items for exact sequential semantics
+ * - Batch-local write overlay, written back once at the end
+ *
+ * The expensive part of a transfer is the random access into the big
+ * balance/allowance tables. Workers do all of those lookups in parallel
+ * and remember both the values they read and the slots they found. The
+ * in-order commit then only touches a small, cache-resident overlay: an
+ * item whose reads still match is committed from its speculative result,
+ * otherwise it is re-executed against the overlay. The outcome, events
+ * and final balances/allowances are identical to applyBatch.
+ */
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "token_contract.hpp"
+#include "transfer_batch.hpp"
+#include "worker_pool.hpp"
+
+/**
+ * @brief Executes transfer batches for TokenContract<EventSink> on a worker pool
+ */
+template <typename EventSink>
+class ParallelExecutor {
+public:
+    /**
+     * @param threads Worker threads including the caller (0 = hardware concurrency)
+     */
+    explicit ParallelExecutor(size_t threads = 0) : _pool(threads) {}
+
+    /**
+     * @brief Apply ops in order, with the same result as token.applyBatch(ops)
+     */
+    BatchStatus execute(TokenContract<EventSink>& token, std::span<const TransferOp> ops) {
+        _reexecuted = 0;
+        if (ops.size() < kMinParallelBatch) {
+            return token.applyBatch(ops);
+        }
+
+        speculate(token, ops);
+        BatchStatus status = commit(token, ops);
+        writeBack(token);
+        return status;
+    }
+
+    /**
+     * @brief Items in the last batch whose speculative reads were stale
+     */
+    size_t reexecuted() const {
+        return _reexecuted;
+    }
+
+private:
+    static constexpr size_t kMinParallelBatch = 256;
+    static constexpr size_t kChunk = 64;
+
+    /**
+     * @brief Result of evaluating one op against given input values
+     */
+    struct Outcome {
+        bool success = false;
+        uint256_t from;
+        uint256_t to;
+        uint256_t allowance;
+    };
+
+    /**
+     * @brief Read set (values and slots seen in the pre-batch state) and speculative result
+     */
+    struct Speculation {
+        uint256_t* fromSlot;
+        uint256_t* toSlot;
+        uint256_t* allowanceSlot;
+        uint256_t fromRead;
+        uint256_t toRead;
+        uint256_t allowanceRead;
+        Outcome outcome;
+    };
+
+    /**
+     * @brief Current value of a key touched by this batch
+     */
+    struct OverlayEntry {
+        uint256_t value;
+        uint256_t original;
+        uint256_t* slot;
+        bool initialized;
+    };
+
+    /**
+     * @brief transfer/transferFrom semantics as a pure function of the read values
+     */
+    static Outcome evaluate(const TransferOp& op, const uint256_t& from, const uint256_t& to,
+                            const uint256_t& allowance) {
+        Outcome out;
+        bool delegated = op.kind == TransferOp::Kind::TransferFrom;
+        if ((delegated && allowance < op.amount) || from < op.amount) {
+            return out;
+        }
+        out.success = true;
+        out.allowance = delegated ? allowance - op.amount : allowance;
+        if (op.from == op.to) {
+            out.from = out.to = from;
+        } else {
+            out.from = from - op.amount;
+            out.to = to + op.amount;
+        }
+        return out;
+    }
+
+    static uint256_t valueAt(const uint256_t* slot) {
+        return slot != nullptr ? *slot : uint256_t(0);
+    }
+
+    /**
+     * @brief Value behind a table lookup, falling back to the contract's snapshot
+     */
+    static uint256_t readBalance(const TokenContract<EventSink>& token, const uint256_t* slot, const Address& owner) {
+        if (slot != nullptr || token._snapshot == nullptr) {
+            return valueAt(slot);
+        }
+        return valueAt(token._snapshot->findBalance(owner));
+    }
+
+    static uint256_t readAllowance(const TokenContract<EventSink>& token, const uint256_t* slot,
+                                   const AllowanceKey& key) {
+        if (slot != nullptr || token._snapshot == nullptr) {
+            return valueAt(slot);
+        }
+        return valueAt(token._snapshot->findAllowance(key.owner, key.spender));
+    }
+
+    /**
+     * @brief Phase 1: run every op against the unmodified tables in parallel
+     */
+    void speculate(TokenContract<EventSink>& token, std::span<const TransferOp> ops) {
+        _speculation.resize(ops.size());
+        _pool.parallelFor(ops.size(), kChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const TransferOp& op = ops[i];
+                Speculation& s = _speculation[i];
+                s.fromSlot = token._balances.find(op.from);
+                s.toSlot = token._balances.find(op.to);
+                s.allowanceSlot = op.kind == TransferOp::Kind::TransferFrom
+                                      ? token._allowances.find({op.from, op.spender})
+                                      : nullptr;
+                s.fromRead = readBalance(token, s.fromSlot, op.from);
+                s.toRead = readBalance(token, s.toSlot, op.to);
+                s.allowanceRead = readAllowance(token, s.allowanceSlot, {op.from, op.spender});
+                s.outcome = evaluate(op, s.fromRead, s.toRead, s.allowanceRead);
+            }
+        });
+    }
+
+    template <typename Map, typename Key>
+    static OverlayEntry& resolve(Map& overlay, const Key& key, uint256_t* slot, const uint256_t& read) {
+        OverlayEntry& e = *overlay.findOrInsert(key).first;
+        if (!e.initialized) {
+            e = {read, read, slot, true};
+        }
+        return e;
+    }
+
+    /**
+     * @brief Phase 2: validate and commit in order into the overlay, emitting events
+     */
+    BatchStatus commit(TokenContract<EventSink>& token, std::span<const TransferOp> ops) {
+        // Sized up front: no rehash, so entry references stay valid per item
+        _balances.clear();
+        _allowances.clear();
+        _balances.reserve(ops.size() * 2);
+        _allowances.reserve(ops.size());
+
+        BatchStatus status(ops.size());
+        for (size_t i = 0; i < ops.size(); i++) {
+            const TransferOp& op = ops[i];
+            const Speculation& s = _speculation[i];
+            bool delegated = op.kind == TransferOp::Kind::TransferFrom;
+
+            OverlayEntry& from = resolve(_balances, op.from, s.fromSlot, s.fromRead);
+            OverlayEntry& to = resolve(_balances, op.to, s.toSlot, s.toRead);
+            OverlayEntry* allowance =
+                delegated ? &resolve(_allowances, AllowanceKey{op.from, op.spender}, s.allowanceSlot, s.allowanceRead)
+                          : nullptr;
+
+            Outcome out;
+            if (from.value == s.fromRead && to.value == s.toRead &&
+                (allowance == nullptr || allowance->value == s.allowanceRead)) {
+                out = s.outcome;
+            } else {
+                out = evaluate(op, from.value, to.value, allowance != nullptr ? allowance->value : uint256_t(0));
+                _reexecuted++;
+            }
+            StatOp statOp = delegated ? StatOp::TransferFrom : StatOp::Transfer;
+            recordOp(statOp);
+            if (!out.success) {
+                bool allowanceShort = allowance != nullptr && allowance->value < op.amount;
+                recordFailure(statOp,
+                              allowanceShort ? FailReason::InsufficientAllowance : FailReason::InsufficientBalance);
+                continue;
+            }
+
+            from.value = out.from;
+            to.value = out.to;
+            token._events.onTransfer({op.from, op.to, op.amount});
+            if (allowance != nullptr) {
+                allowance->value = out.allowance;
+                token._events.onApproval({op.from, op.spender, out.allowance});
+            }
+            status.markSucceeded(i);
+        }
+        return status;
+    }
+
+    /**
+     * @brief Phase 3: store overlay values into the contract's tables
+     *
+     * Existing slots are written through the pointers found in phase 1
+     * first; changed keys without a slot (new holders, or accounts only in
+     * the snapshot) are inserted afterwards, since an insertion can grow
+     * the table and move every slot.
+     */
+    void writeBack(TokenContract<EventSink>& token) {
+        _newBalances.clear();
+        _newAllowances.clear();
+        for (const auto& e : _balances) {
+            if (e.second.slot != nullptr) {
+                token.storeBalance(e.first, *e.second.slot, e.second.value);
+            } else if (e.second.value != e.second.original) {
+                _newBalances.push_back({e.first, e.second.value});
+            }
+        }
+        for (const auto& e : _allowances) {
+            if (e.second.slot != nullptr) {
+                token.storeAllowance(e.first, *e.second.slot, e.second.value);
+            } else if (e.second.value != e.second.original) {
+                _newAllowances.push_back({e.first, e.second.value});
+            }
+        }
+
+        for (const auto& [owner, value] : _newBalances) {
+            token.storeBalance(owner, token.balanceEntry(owner), value);
+        }
+        for (const auto& [key, value] : _newAllowances) {
+            token.storeAllowance(key, token.allowanceEntry(key), value);
+        }
+    }
+
+    WorkerPool _pool;
+    std::vector<Speculation> _speculation;
+    FlatHashMap<Address, OverlayEntry, AddressHash> _balances;
+    FlatHashMap<AllowanceKey, OverlayEntry, AllowanceKeyHash> _allowances;
+    std::vector<std::pair<Address, uint256_t>> _newBalances;
+    std::vector<std::pair<AllowanceKey, uint256_t>> _newAllowances;
+    size_t _reexecuted = 0;
+};
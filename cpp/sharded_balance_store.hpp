@@ -0,0 +1,318 @@
+/**
+ * @file
+ * @brief Sharded balance store with wait-free seqlock readers
+ *
+ * Demonstrates:
+ * - hash(Address) mod N sharding, one writer mutex per shard
+ * - Seqlock read path: readers never take a lock or block a writer
+ * - Deadlock-free two-shard transfers (locks taken in shard order)
+ * - Table growth without reader-side reclamation
+ *
+ * Slot words are std::atomic with relaxed ordering, so the optimistic
+ * reads a seqlock relies on are well defined; on x86 they compile to
+ * plain loads and stores.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "address.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief Balances readable while transfers are being applied
+ *
+ * balanceOf may run on any number of threads concurrently with credit
+ * and transfer. Each individual balance read is consistent; a reader
+ * sampling both sides of a transfer in different shards can observe
+ * one side before the other.
+ *
+ * @tparam ShardCount Number of independently locked shards
+ */
+template <size_t ShardCount = 64>
+class ShardedBalanceStore {
+    static_assert(ShardCount > 0);
+
+public:
+    ShardedBalanceStore() {
+        for (auto& shard : _shards) {
+            shard.tables.push_back(std::make_unique<Table>(kInitialCapacity));
+            shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+        }
+    }
+
+    ShardedBalanceStore(const ShardedBalanceStore&) = delete;
+    ShardedBalanceStore& operator=(const ShardedBalanceStore&) = delete;
+
+    /**
+     * @brief Current balance; never blocks
+     */
+    uint256_t balanceOf(const Address& owner) const {
+        Key key = toKey(owner);
+        size_t hash = AddressHash{}(owner);
+        const Shard& shard = _shards[shardIndex(hash)];
+        for (;;) {
+            uint64_t before = shard.seq.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                const Table* table = shard.table.load(std::memory_order_acquire);
+                uint256_t value = table->read(key, hash);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (shard.seq.load(std::memory_order_relaxed) == before) {
+                    return value;
+                }
+            }
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+    }
+
+    /**
+     * @brief Add amount to owner's balance (minting / initial load)
+     */
+    void credit(const Address& owner, const uint256_t& amount) {
+        Key key = toKey(owner);
+        size_t hash = AddressHash{}(owner);
+        Shard& shard = _shards[shardIndex(hash)];
+        std::lock_guard<std::mutex> lock(shard.writer);
+        WriteWindow window(shard);
+        Slot& slot = shard.slotFor(key, hash);
+        Table::store(slot, Table::load(slot) + amount);
+    }
+
+    /**
+     * @brief Move amount from one holder to another
+     *
+     * Locks only the one or two shards involved, lower shard index first.
+     *
+     * @return false (and no change) if from holds less than amount
+     */
+    bool transfer(const Address& from, const Address& to, const uint256_t& amount) {
+        Key fromKey = toKey(from);
+        Key recipientKey = toKey(to);
+        size_t fromHash = AddressHash{}(from);
+        size_t toHash = AddressHash{}(to);
+        size_t a = shardIndex(fromHash);
+        size_t b = shardIndex(toHash);
+
+        Shard& fromShard = _shards[a];
+        Shard& toShard = _shards[b];
+        std::unique_lock<std::mutex> first(_shards[a < b ? a : b].writer);
+        std::unique_lock<std::mutex> second;
+        if (a != b) {
+            second = std::unique_lock<std::mutex>(_shards[a < b ? b : a].writer);
+        }
+
+        // Writers are excluded, so this read needs no seqlock
+        uint256_t balance = fromShard.table.load(std::memory_order_relaxed)->read(fromKey, fromHash);
+        if (balance < amount) {
+            return false;
+        }
+        if (from == to) {
+            return true;
+        }
+
+        {
+            WriteWindow window(fromShard);
+            Table::store(fromShard.slotFor(fromKey, fromHash), balance - amount);
+        }
+        {
+            WriteWindow window(toShard);
+            Slot& slot = toShard.slotFor(recipientKey, toHash);
+            Table::store(slot, Table::load(slot) + amount);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Number of accounts ever credited
+     */
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.writer);
+            n += shard.table.load(std::memory_order_relaxed)->size;
+        }
+        return n;
+    }
+
+private:
+    static constexpr size_t kInitialCapacity = 16;
+
+    /**
+     * @brief Address widened to three words, zero padded
+     */
+    struct Key {
+        uint64_t words[3];
+    };
+
+    static Key toKey(const Address& a) {
+        Key k{};
+        std::memcpy(k.words, a.bytes, Address::kSize);
+        return k;
+    }
+
+    static size_t shardIndex(size_t hash) {
+        return (hash >> 40) % ShardCount;
+    }
+
+    /**
+     * @brief Slot of the per-shard open-addressing table
+     */
+    struct Slot {
+        std::atomic<uint64_t> used{0};
+        std::atomic<uint64_t> key[3] = {};
+        std::atomic<uint64_t> value[4] = {};
+    };
+
+    /**
+     * @brief Linear-probing table at most half full; replaced, never resized in place
+     */
+    struct Table {
+        explicit Table(size_t cap) : capacity(cap), slots(new Slot[cap]) {}
+
+        static bool matches(const Slot& slot, const Key& key) {
+            return slot.key[0].load(std::memory_order_relaxed) == key.words[0] &&
+                   slot.key[1].load(std::memory_order_relaxed) == key.words[1] &&
+                   slot.key[2].load(std::memory_order_relaxed) == key.words[2];
+        }
+
+        static uint256_t load(const Slot& slot) {
+            return uint256_t::fromLimbs(slot.value[0].load(std::memory_order_relaxed),
+                                        slot.value[1].load(std::memory_order_relaxed),
+                                        slot.value[2].load(std::memory_order_relaxed),
+                                        slot.value[3].load(std::memory_order_relaxed));
+        }
+
+        static void store(Slot& slot, const uint256_t& v) {
+            for (int i = 0; i < 4; i++) {
+                slot.value[i].store(v.limb(i), std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Balance for key, zero if absent; safe to call racing a writer
+         *
+         * The probe is bounded by capacity so torn reads cannot loop forever;
+         * the caller's seqlock check discards any such result.
+         */
+        uint256_t read(const Key& key, size_t hash) const {
+            size_t mask = capacity - 1;
+            for (size_t n = 0, i = hash & mask; n < capacity; n++, i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.used.load(std::memory_order_relaxed) == 0) {
+                    break;
+                }
+                if (matches(slot, key)) {
+                    return load(slot);
+                }
+            }
+            return 0;
+        }
+
+        Slot* find(const Key& key, size_t hash) {
+            size_t mask = capacity - 1;
+            for (size_t i = hash & mask;; i = (i + 1) & mask) {
+                Slot& slot = slots[i];
+                if (slot.used.load(std::memory_order_relaxed) == 0) {
+                    return nullptr;
+                }
+                if (matches(slot, key)) {
+                    return &slot;
+                }
+            }
+        }
+
+        Slot& insert(const Key& key, size_t hash) {
+            size_t mask = capacity - 1;
+            size_t i = hash & mask;
+            while (slots[i].used.load(std::memory_order_relaxed) != 0) {
+                i = (i + 1) & mask;
+            }
+            Slot& slot = slots[i];
+            for (int w = 0; w < 3; w++) {
+                slot.key[w].store(key.words[w], std::memory_order_relaxed);
+            }
+            slot.used.store(1, std::memory_order_relaxed);
+            size++;
+            return slot;
+        }
+
+        size_t capacity;
+        size_t size = 0;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex writer;
+        std::atomic<uint64_t> seq{0};
+        std::atomic<Table*> table{nullptr};
+        // Every table this shard ever used. Readers may still be probing a
+        // replaced table, so it stays allocated until the store is destroyed;
+        // capacities double, so the retired ones total less than the live one.
+        std::vector<std::unique_ptr<Table>> tables;
+
+        /**
+         * @brief Slot for key, inserting (and growing) if needed; inside a write window
+         */
+        Slot& slotFor(const Key& key, size_t hash) {
+            Table* t = table.load(std::memory_order_relaxed);
+            if (Slot* slot = t->find(key, hash)) {
+                return *slot;
+            }
+            if ((t->size + 1) * 2 > t->capacity) {
+                t = grow(t);
+            }
+            return t->insert(key, hash);
+        }
+
+        Table* grow(Table* old) {
+            auto next = std::make_unique<Table>(old->capacity * 2);
+            for (size_t i = 0; i < old->capacity; i++) {
+                const Slot& slot = old->slots[i];
+                if (slot.used.load(std::memory_order_relaxed) != 0) {
+                    Key key{};
+                    for (int w = 0; w < 3; w++) {
+                        key.words[w] = slot.key[w].load(std::memory_order_relaxed);
+                    }
+                    Address a;
+                    std::memcpy(a.bytes, key.words, Address::kSize);
+                    Table::store(next->insert(key, AddressHash{}(a)), Table::load(slot));
+                }
+            }
+            Table* raw = next.get();
+            tables.push_back(std::move(next));
+            table.store(raw, std::memory_order_release);
+            return raw;
+        }
+    };
+
+    /**
+     * @brief Seqlock writer section: odd sequence while open
+     */
+    class WriteWindow {
+    public:
+        explicit WriteWindow(Shard& shard) : _shard(shard) {
+            uint64_t s = _shard.seq.load(std::memory_order_relaxed);
+            _shard.seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        ~WriteWindow() {
+            uint64_t s = _shard.seq.load(std::memory_order_relaxed);
+            _shard.seq.store(s + 1, std::memory_order_release);
+        }
+
+    private:
+        Shard& _shard;
+    };
+
+    Shard _shards[ShardCount];
+};
@@ -0,0 +1,756 @@
+/**
+ * @file
+ * @brief ERC-20 interface and token contract
+ *
+ * Demonstrates:
+ * - Concrete (non-virtual) ERC-20 contract
+ * - Flat hash map balance and allowance storage
+ * - Single-probe transfer paths
+ * - Prefetching batch apply
+ * - Copy-on-write layering over a mapped snapshot
+ * - Checkpoint/revert through an undo log
+ * - Optional sorted holder index and cursor-paged iteration
+ * - Compile-time optional counters and latency histograms (token_stats.hpp)
+ * - Pluggable event sink instead of inline logging
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "address.hpp"
+#include "erc20.hpp"
+#include "event_sink.hpp"
+#include "flat_hash_map.hpp"
+#include "token_snapshot.hpp"
+#include "token_stats.hpp"
+#include "transfer_batch.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief (owner, spender) key of the flattened allowance index
+ */
+struct AllowanceKey {
+    Address owner;
+    Address spender;
+
+    friend bool operator==(const AllowanceKey& a, const AllowanceKey& b) = default;
+};
+
+struct AllowanceKeyHash {
+    size_t operator()(const AllowanceKey& k) const {
+        size_t h = AddressHash{}(k.owner);
+        return h ^ (AddressHash{}(k.spender) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2));
+    }
+};
+
+/**
+ * @brief One row of a topHolders result
+ */
+struct HolderBalance {
+    Address owner;
+    uint256_t balance;
+};
+
+/**
+ * @brief Orders holders by balance, largest first, then by address
+ */
+struct RichestFirst {
+    bool operator()(const HolderBalance& a, const HolderBalance& b) const {
+        if (a.balance != b.balance) {
+            return b.balance < a.balance;
+        }
+        return a.owner < b.owner;
+    }
+};
+
+template <typename EventSink>
+class ParallelExecutor;
+class JournalReplay;
+
+/**
+ * @brief Token contract implementation
+ *
+ * Non-virtual so generic code can inline it; wrap in Erc20Adapter when an
+ * IERC20 is needed.
+ *
+ * @tparam EventSink Receives Transfer/Approval events (see event_sink.hpp).
+ *         transferFrom emits Transfer followed by Approval with the
+ *         remaining allowance.
+ */
+template <typename EventSink = NullEventSink>
+class TokenContract {
+private:
+    std::string _name;
+    std::string _symbol;
+    uint8_t _decimals;
+    uint256_t _totalSupply;
+    FlatHashMap<Address, uint256_t, AddressHash> _balances;
+    FlatHashMap<AllowanceKey, uint256_t, AllowanceKeyHash> _allowances;
+    EventSink _events;
+
+    // Optional read-only base state. The hash tables hold every account
+    // written since loading and shadow the snapshot's record for it.
+    std::shared_ptr<const MappedSnapshot> _snapshot;
+
+    // Maintained on every balance write so the dashboard queries are O(1)
+    uint256_t _heldByContract;
+    size_t _activeHolders = 0;
+
+    /**
+     * @brief Value a balance (spender unused) or allowance had before a write
+     */
+    struct UndoEntry {
+        AllowanceKey key;
+        uint256_t prior;
+        bool allowance;
+    };
+
+    // Undo log, only appended to while a checkpoint is open. _checkpoints[i]
+    // is the log length when checkpoint i was taken.
+    std::vector<UndoEntry> _undo;
+    std::vector<size_t> _checkpoints;
+
+    // Every non-zero balance in RichestFirst order, once enabled
+    bool _indexHolders = false;
+    std::set<HolderBalance, RichestFirst> _holderIndex;
+
+    // Reads and writes the tables directly on behalf of applyBatch
+    friend class ParallelExecutor<EventSink>;
+    // Applies recorded effects during recovery (see token_journal.hpp)
+    friend class JournalReplay;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    TokenContract(
+        std::string name,
+        std::string symbol,
+        uint8_t decimals,
+        uint256_t initialSupply
+    ) {
+        _name = name;
+        _symbol = symbol;
+        _decimals = decimals;
+        _totalSupply = initialSupply;
+
+        // Mint initial supply to contract owner (address 0x0)
+        storeBalance(Address::zero(), _balances[Address::zero()], initialSupply);
+    }
+
+    /**
+     * @brief Open a contract on top of a mapped snapshot (see token_snapshot.hpp)
+     *
+     * Nothing is copied up front: reads of untouched accounts go to the
+     * mapping and an account's record is copied into the hash tables the
+     * first time it is written.
+     */
+    explicit TokenContract(std::shared_ptr<const MappedSnapshot> snapshot) : _snapshot(std::move(snapshot)) {
+        const SnapshotHeader& h = _snapshot->header();
+        _name = std::string(h.name, std::find(h.name, std::end(h.name), '\0'));
+        _symbol = std::string(h.symbol, std::find(h.symbol, std::end(h.symbol), '\0'));
+        _decimals = h.decimals;
+        _totalSupply = h.totalSupply;
+
+        // Snapshots only contain non-zero balances
+        _activeHolders = h.balanceCount;
+        if (const uint256_t* held = _snapshot->findBalance(Address::zero())) {
+            _heldByContract = *held;
+        }
+    }
+
+    /**
+     * @brief Event sink receiving this contract's events
+     */
+    EventSink& events() {
+        return _events;
+    }
+
+    /**
+     * @brief Get token name
+     */
+    std::string name() const {
+        return _name;
+    }
+
+    /**
+     * @brief Get token symbol
+     */
+    std::string symbol() const {
+        return _symbol;
+    }
+
+    /**
+     * @brief Get token decimals
+     */
+    uint8_t decimals() const {
+        return _decimals;
+    }
+
+    /**
+     * @brief Get total supply
+     */
+    uint256_t totalSupply() const {
+        return _totalSupply;
+    }
+
+    /**
+     * @brief Tokens held outside the contract owner address
+     */
+    uint256_t circulatingSupply() const {
+        return _totalSupply - _heldByContract;
+    }
+
+    /**
+     * @brief Tokens still held by the contract owner address (0x0)
+     */
+    uint256_t heldByContract() const {
+        return _heldByContract;
+    }
+
+    /**
+     * @brief Number of addresses with a non-zero balance
+     */
+    size_t activeHolderCount() const {
+        return _activeHolders;
+    }
+
+    /**
+     * @brief Pre-size the balance table for an expected number of holders
+     */
+    void reserve(size_t holders) {
+        _balances.reserve(holders);
+    }
+
+    /**
+     * @brief Get balance of address
+     */
+    uint256_t balanceOf(const Address& owner) const {
+        const uint256_t* balance = findBalance(owner);
+        return balance != nullptr ? *balance : uint256_t(0);
+    }
+
+    /**
+     * @brief Get allowance
+     */
+    uint256_t allowance(const Address& owner, const Address& spender) const {
+        const uint256_t* allowed = findAllowance({owner, spender});
+        return allowed != nullptr ? *allowed : uint256_t(0);
+    }
+
+    /**
+     * @brief Call fn(owner, balance) for every non-zero balance, in no particular order
+     */
+    template <typename Fn>
+    void forEachBalance(Fn&& fn) const {
+        for (const auto& entry : _balances) {
+            if (!entry.second.isZero()) {
+                fn(entry.first, entry.second);
+            }
+        }
+        if (_snapshot != nullptr) {
+            for (const BalanceRecord& r : _snapshot->balances()) {
+                if (!_balances.contains(r.owner)) {
+                    fn(r.owner, r.value);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Value forEachBalance returns once every balance has been visited
+     */
+    static constexpr size_t kCursorEnd = SIZE_MAX;
+
+    /**
+     * @brief Call fn(owner, balance) for at most limit non-zero balances from cursor on
+     *
+     * Start at 0 and pass each returned cursor back in until it is
+     * kCursorEnd. Allocates nothing. Inserting new holders between pages
+     * can rehash the table, after which the walk may skip or repeat some
+     * accounts.
+     *
+     * @return Cursor of the next page
+     */
+    template <typename Fn>
+    size_t forEachBalance(size_t cursor, size_t limit, Fn&& fn) const {
+        // Positions [0, capacity) are table slots, the rest snapshot records
+        size_t tableSlots = _balances.capacity();
+        size_t visited = 0;
+        if (cursor < tableSlots) {
+            for (auto it = _balances.iteratorAt(cursor); it != _balances.end(); ++it) {
+                if (it->second.isZero()) {
+                    continue;
+                }
+                if (visited == limit) {
+                    return it.slot();
+                }
+                fn(it->first, it->second);
+                visited++;
+            }
+            cursor = tableSlots;
+        }
+        if (_snapshot != nullptr) {
+            auto records = _snapshot->balances();
+            for (size_t i = cursor - tableSlots; i < records.size(); i++) {
+                if (_balances.contains(records[i].owner)) {
+                    continue;
+                }
+                if (visited == limit) {
+                    return tableSlots + i;
+                }
+                fn(records[i].owner, records[i].value);
+                visited++;
+            }
+        }
+        return kCursorEnd;
+    }
+
+    /**
+     * @brief Keep a sorted index of holders so topHolders is O(n)
+     *
+     * Built once from the current balances; afterwards every balance write
+     * also costs an O(log holders) tree update (no allocation for holders
+     * already indexed).
+     */
+    void enableHolderIndex() {
+        if (_indexHolders) {
+            return;
+        }
+        _indexHolders = true;
+        forEachBalance([&](const Address& owner, const uint256_t& balance) {
+            _holderIndex.insert({owner, balance});
+        });
+    }
+
+    /**
+     * @brief The n largest balances, largest first (ties by address)
+     *
+     * Reads the holder index when enabled, otherwise scans every balance.
+     */
+    std::vector<HolderBalance> topHolders(size_t n) const {
+        std::vector<HolderBalance> top;
+        if (_indexHolders) {
+            top.reserve(std::min(n, _holderIndex.size()));
+            for (auto it = _holderIndex.begin(); it != _holderIndex.end() && top.size() < n; ++it) {
+                top.push_back(*it);
+            }
+            return top;
+        }
+
+        // Max-heap under RichestFirst: the front is the poorest one kept
+        if (n == 0) {
+            return top;
+        }
+        top.reserve(n);
+        forEachBalance([&](const Address& owner, const uint256_t& balance) {
+            HolderBalance h{owner, balance};
+            if (top.size() < n) {
+                top.push_back(h);
+                std::push_heap(top.begin(), top.end(), RichestFirst{});
+            } else if (RichestFirst{}(h, top.front())) {
+                std::pop_heap(top.begin(), top.end(), RichestFirst{});
+                top.back() = h;
+                std::push_heap(top.begin(), top.end(), RichestFirst{});
+            }
+        });
+        std::sort_heap(top.begin(), top.end(), RichestFirst{});
+        return top;
+    }
+
+    /**
+     * @brief Call fn(owner, spender, allowance) for every non-zero allowance
+     */
+    template <typename Fn>
+    void forEachAllowance(Fn&& fn) const {
+        for (const auto& entry : _allowances) {
+            if (!entry.second.isZero()) {
+                fn(entry.first.owner, entry.first.spender, entry.second);
+            }
+        }
+        if (_snapshot != nullptr) {
+            for (const AllowanceRecord& r : _snapshot->allowances()) {
+                if (!_allowances.contains({r.owner, r.spender})) {
+                    fn(r.owner, r.spender, r.value);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Approve spender to spend tokens
+     */
+    bool approve(const Address& spender, uint256_t amount) {
+        ScopedOpTimer timer(StatOp::Approve);
+        Address owner = msgSender();
+        if (balanceOf(owner) < amount) {
+            recordFailure(StatOp::Approve, FailReason::InsufficientBalance);
+            return false;
+        }
+
+        storeAllowance({owner, spender}, allowanceEntry({owner, spender}), amount);
+        _events.onApproval({owner, spender, amount});
+        return true;
+    }
+
+    /**
+     * @brief Transfer tokens
+     */
+    bool transfer(const Address& to, uint256_t amount) {
+        return executeTransfer(msgSender(), to, amount);
+    }
+
+    /**
+     * @brief Transfer from approved allowance
+     */
+    bool transferFrom(const Address& from, const Address& to, uint256_t amount) {
+        return executeTransferFrom(msgSender(), from, to, amount);
+    }
+
+    /**
+     * @brief Apply a block of replayed transfers in order
+     *
+     * Each item has the same semantics and events as the corresponding
+     * transfer/transferFrom call made by its recorded sender. Table slots
+     * for upcoming items are prefetched in two stages (control group,
+     * then matching entries) so their cache misses overlap with the
+     * current item's work.
+     *
+     * @return Bit i set when ops[i] succeeded
+     */
+    BatchStatus applyBatch(std::span<const TransferOp> ops) {
+        constexpr size_t kEntryDistance = 4;
+        constexpr size_t kGroupDistance = 8;
+
+        BatchStatus status(ops.size());
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (i + kGroupDistance < ops.size()) {
+                prefetchGroups(ops[i + kGroupDistance]);
+            }
+            if (i + kEntryDistance < ops.size()) {
+                prefetchEntries(ops[i + kEntryDistance]);
+            }
+            if (apply(ops[i])) {
+                status.markSucceeded(i);
+            }
+        }
+        return status;
+    }
+
+    /**
+     * @brief Open a nested checkpoint
+     *
+     * From now on every balance and allowance write logs the value it
+     * replaces, so revertTo costs O(writes since the checkpoint) rather
+     * than a copy of the state. Events already emitted are not retracted;
+     * simulations that revert should use a sink that can discard them.
+     *
+     * @return Id to pass to revertTo (the nesting depth before this call)
+     */
+    size_t checkpoint() {
+        _checkpoints.push_back(_undo.size());
+        return _checkpoints.size() - 1;
+    }
+
+    /**
+     * @brief Undo every write since checkpoint id and close it and all inner checkpoints
+     * @return false if id is not an open checkpoint
+     */
+    bool revertTo(size_t id) {
+        if (id >= _checkpoints.size()) {
+            return false;
+        }
+        size_t mark = _checkpoints[id];
+        while (_undo.size() > mark) {
+            const UndoEntry& e = _undo.back();
+            if (e.allowance) {
+                *_allowances.find(e.key) = e.prior;
+            } else {
+                assignBalance(e.key.owner, *_balances.find(e.key.owner), e.prior);
+            }
+            _undo.pop_back();
+        }
+        _checkpoints.resize(id);
+        return true;
+    }
+
+    /**
+     * @brief Close the innermost checkpoint, keeping its writes
+     *
+     * The writes stay revertible through any enclosing checkpoint.
+     *
+     * @return false if no checkpoint is open
+     */
+    bool commit() {
+        if (_checkpoints.empty()) {
+            return false;
+        }
+        _checkpoints.pop_back();
+        if (_checkpoints.empty()) {
+            _undo.clear();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Operation counters and latency histograms, summed over all threads
+     *
+     * Process-wide (shared by every contract) and all zero unless built
+     * with ERC20_ENABLE_STATS=1.
+     */
+    static TokenStats stats() {
+        return collectTokenStats();
+    }
+
+    /**
+     * @brief Get message sender (simulated)
+     */
+    Address msgSender() const {
+        return Address::zero(); // In real contract, this is msg.sender
+    }
+
+    /**
+     * @brief Print contract state
+     */
+    void printState() const {
+        std::cout << "\n=== TOKEN CONTRACT STATE ===" << std::endl;
+        std::cout << "Name: " << _name << std::endl;
+        std::cout << "Symbol: " << _symbol << std::endl;
+        std::cout << "Decimals: " << (int)_decimals << std::endl;
+        std::cout << "Total Supply: " << _totalSupply << std::endl;
+        std::cout << "\nTop holders:" << std::endl;
+
+        for (const HolderBalance& h : topHolders(kPrintedHolders)) {
+            std::cout << "  " << h.owner << ": " << h.balance << std::endl;
+        }
+        if (_activeHolders > kPrintedHolders) {
+            std::cout << "  ... " << _activeHolders - kPrintedHolders << " more" << std::endl;
+        }
+        std::cout << "\nTotal holders: " << _activeHolders << std::endl;
+        std::cout << "=========================" << std::endl;
+    }
+
+private:
+    static constexpr size_t kPrintedHolders = 10;
+
+    bool executeTransfer(const Address& sender, const Address& to, const uint256_t& amount) {
+        ScopedOpTimer timer(StatOp::Transfer);
+
+        // Check balance
+        uint256_t* senderBalance = balanceSlot(sender);
+        if (!covers(senderBalance, amount)) {
+            recordFailure(StatOp::Transfer, FailReason::InsufficientBalance);
+            return false;
+        }
+
+        // Update balances
+        moveBalance(senderBalance, sender, to, amount);
+
+        _events.onTransfer({sender, to, amount});
+        return true;
+    }
+
+    bool executeTransferFrom(const Address& spender, const Address& from, const Address& to,
+                             const uint256_t& amount) {
+        ScopedOpTimer timer(StatOp::TransferFrom);
+
+        // Check allowance; the handle is reused for the decrement below
+        uint256_t* allowed = allowanceSlot({from, spender});
+        if (!covers(allowed, amount)) {
+            recordFailure(StatOp::TransferFrom, FailReason::InsufficientAllowance);
+            return false;
+        }
+
+        // Check balance
+        uint256_t* fromBalance = balanceSlot(from);
+        if (!covers(fromBalance, amount)) {
+            recordFailure(StatOp::TransferFrom, FailReason::InsufficientBalance);
+            return false;
+        }
+
+        // Update allowance
+        if (allowed != nullptr) {
+            storeAllowance({from, spender}, *allowed, *allowed - amount);
+        }
+
+        // Update balances
+        moveBalance(fromBalance, from, to, amount);
+
+        _events.onTransfer({from, to, amount});
+        _events.onApproval({from, spender, allowed != nullptr ? *allowed : uint256_t(0)});
+        return true;
+    }
+
+    bool apply(const TransferOp& op) {
+        if (op.kind == TransferOp::Kind::TransferFrom) {
+            return executeTransferFrom(op.spender, op.from, op.to, op.amount);
+        }
+        return executeTransfer(op.from, op.to, op.amount);
+    }
+
+    void prefetchGroups(const TransferOp& op) const {
+        _balances.prefetchGroup(op.from);
+        _balances.prefetchGroup(op.to);
+        if (op.kind == TransferOp::Kind::TransferFrom) {
+            _allowances.prefetchGroup({op.from, op.spender});
+        }
+    }
+
+    void prefetchEntries(const TransferOp& op) const {
+        _balances.prefetchEntry(op.from);
+        _balances.prefetchEntry(op.to);
+        if (op.kind == TransferOp::Kind::TransferFrom) {
+            _allowances.prefetchEntry({op.from, op.spender});
+        }
+    }
+
+    const uint256_t* findBalance(const Address& owner) const {
+        const uint256_t* balance = _balances.find(owner);
+        if (balance == nullptr && _snapshot != nullptr) {
+            balance = _snapshot->findBalance(owner);
+        }
+        return balance;
+    }
+
+    const uint256_t* findAllowance(const AllowanceKey& key) const {
+        const uint256_t* allowed = _allowances.find(key);
+        if (allowed == nullptr && _snapshot != nullptr) {
+            allowed = _snapshot->findAllowance(key.owner, key.spender);
+        }
+        return allowed;
+    }
+
+    /**
+     * @brief Writable balance slot, copying it up from the snapshot if needed
+     * @return nullptr if the account has never held tokens
+     */
+    uint256_t* balanceSlot(const Address& owner) {
+        if (uint256_t* balance = _balances.find(owner)) {
+            return balance;
+        }
+        const uint256_t* base = _snapshot != nullptr ? _snapshot->findBalance(owner) : nullptr;
+        return base != nullptr ? &(_balances[owner] = *base) : nullptr;
+    }
+
+    /**
+     * @brief Writable balance slot, created (zero or snapshot value) if missing
+     */
+    uint256_t& balanceEntry(const Address& owner) {
+        auto [balance, inserted] = _balances.findOrInsert(owner);
+        if (inserted && _snapshot != nullptr) {
+            if (const uint256_t* base = _snapshot->findBalance(owner)) {
+                *balance = *base;
+            }
+        }
+        return *balance;
+    }
+
+    uint256_t* allowanceSlot(const AllowanceKey& key) {
+        if (uint256_t* allowed = _allowances.find(key)) {
+            return allowed;
+        }
+        const uint256_t* base = _snapshot != nullptr ? _snapshot->findAllowance(key.owner, key.spender) : nullptr;
+        return base != nullptr ? &(_allowances[key] = *base) : nullptr;
+    }
+
+    uint256_t& allowanceEntry(const AllowanceKey& key) {
+        auto [allowed, inserted] = _allowances.findOrInsert(key);
+        if (inserted && _snapshot != nullptr) {
+            if (const uint256_t* base = _snapshot->findAllowance(key.owner, key.spender)) {
+                *allowed = *base;
+            }
+        }
+        return *allowed;
+    }
+
+    /**
+     * @brief Whether a looked-up slot (nullptr meaning zero) holds at least amount
+     */
+    static bool covers(const uint256_t* slot, const uint256_t& amount) {
+        return slot == nullptr ? amount.isZero() : amount <= *slot;
+    }
+
+    /**
+     * @brief Debit a checked sender slot, then credit the recipient
+     *
+     * The debit must come first: inserting a new recipient can grow the
+     * table and move the sender's slot.
+     */
+    void moveBalance(uint256_t* fromBalance, const Address& from, const Address& to, const uint256_t& amount) {
+        if (fromBalance != nullptr) {
+            storeBalance(from, *fromBalance, *fromBalance - amount);
+        }
+        uint256_t& toBalance = balanceEntry(to);
+        storeBalance(to, toBalance, toBalance + amount);
+    }
+
+    /**
+     * @brief Write a balance slot, keeping the counters and undo log current
+     *
+     * Every balance mutation goes through here.
+     */
+    void storeBalance(const Address& owner, uint256_t& slot, const uint256_t& value) {
+        if (!_checkpoints.empty()) {
+            _undo.push_back({{owner, Address::zero()}, slot, false});
+        }
+        assignBalance(owner, slot, value);
+    }
+
+    /**
+     * @brief Write an allowance slot, logging the old value under a checkpoint
+     *
+     * Every allowance mutation goes through here.
+     */
+    void storeAllowance(const AllowanceKey& key, uint256_t& slot, const uint256_t& value) {
+        if (!_checkpoints.empty()) {
+            _undo.push_back({key, slot, true});
+        }
+        slot = value;
+    }
+
+    /**
+     * @brief Write a balance slot, keeping the supply and holder counters current
+     *
+     * Restoring an old value restores the counters too.
+     */
+    void assignBalance(const Address& owner, uint256_t& slot, const uint256_t& value) {
+        if (_indexHolders && slot != value) {
+            reindexHolder(owner, slot, value);
+        }
+        _activeHolders += static_cast<size_t>(!value.isZero()) - static_cast<size_t>(!slot.isZero());
+        if (owner.isZero()) {
+            _heldByContract = value;
+        }
+        slot = value;
+    }
+
+    /**
+     * @brief Move owner's holder index node from balance before to after
+     */
+    void reindexHolder(const Address& owner, const uint256_t& before, const uint256_t& after) {
+        std::set<HolderBalance, RichestFirst>::node_type node;
+        if (!before.isZero()) {
+            node = _holderIndex.extract({owner, before});
+        }
+        if (after.isZero()) {
+            return;
+        }
+        if (node) {
+            node.value().balance = after;
+            _holderIndex.insert(std::move(node));
+        } else {
+            _holderIndex.insert({owner, after});
+        }
+    }
+};
+
+static_assert(Erc20Token<TokenContract<>>);
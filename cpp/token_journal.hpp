@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @brief Append-only journal of token state changes with group commit
+ *
+ * Demonstrates:
+ * - Journal as an EventSink: every Transfer/Approval becomes a record
+ * - Fixed 88-byte checksummed binary records with sequence numbers
+ * - Group commit: one write + fdatasync per batch or time window
+ * - Recovery as snapshot + journal-tail replay, stopping at a torn tail
+ *
+ * Records describe effects, not requests: Transfer moves value from one
+ * balance to another, Approval sets an allowance to an absolute value
+ * (transferFrom emits one with the remaining allowance). Replaying them
+ * therefore needs no checks and reproduces the state exactly.
+ *
+ * Typical recovery:
+ *
+ *   auto snapshot = std::shared_ptr<const MappedSnapshot>(MappedSnapshot::open("token.snap"));
+ *   TokenContract<JournalSink> token(snapshot);
+ *   replayJournal("token.journal", token, snapshot->header().sequence);
+ *   token.events().open("token.journal");
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "address.hpp"
+#include "event_sink.hpp"
+#include "token_snapshot.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief One journal entry
+ */
+struct JournalRecord {
+    enum class Kind : uint8_t { Transfer = 1, Approval = 2 };
+
+    Kind kind;
+    uint8_t reserved[3];
+    // Truncated snapshotChecksum of every other byte of the record
+    uint32_t checksum;
+    uint64_t sequence;
+    // Transfer: from, to. Approval: owner, spender.
+    Address a;
+    Address b;
+    uint256_t value;
+
+    uint32_t computeChecksum() const {
+        JournalRecord copy = *this;
+        copy.checksum = 0;
+        return static_cast<uint32_t>(snapshotChecksum(&copy, sizeof(copy)));
+    }
+};
+
+static_assert(sizeof(JournalRecord) == 88 && offsetof(JournalRecord, value) == 56);
+
+/**
+ * @brief Event sink appending to a journal file
+ *
+ * Appends are buffered. The buffer is written and fdatasync'ed as one
+ * group when it reaches maxBatch records, when the oldest pending
+ * record is older than maxDelay, on commit(), and on destruction. An
+ * operation is durable once committedSequence() reaches its sequence.
+ *
+ * The sink has no timer of its own: maxDelay is checked on each append
+ * and on poll(). An owner that can go quiet after a burst must call
+ * poll() from its event loop (at least every maxDelay) for the latency
+ * bound to hold, from the same thread that drives the contract.
+ */
+class JournalSink {
+public:
+    JournalSink() = default;
+
+    JournalSink(const JournalSink&) = delete;
+    JournalSink& operator=(const JournalSink&) = delete;
+
+    ~JournalSink() {
+        close();
+    }
+
+    /**
+     * @brief Open (or create) a journal, continuing its sequence numbers
+     *
+     * A torn record left by a crash during a write is cut off.
+     *
+     * @return false if the file cannot be opened or repaired
+     */
+    bool open(const std::string& path, size_t maxBatch = 1024,
+              std::chrono::microseconds maxDelay = std::chrono::milliseconds(2)) {
+        close();
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        uint64_t validBytes = 0;
+        uint64_t lastSequence = 0;
+        scanJournal(fd, validBytes, lastSequence);
+        if (::ftruncate(fd, static_cast<off_t>(validBytes)) != 0 ||
+            ::lseek(fd, static_cast<off_t>(validBytes), SEEK_SET) < 0) {
+            ::close(fd);
+            return false;
+        }
+
+        _fd = fd;
+        _maxBatch = maxBatch == 0 ? 1 : maxBatch;
+        _maxDelay = maxDelay;
+        _nextSequence = lastSequence + 1;
+        _committed = lastSequence;
+        _failed = false;
+        _pending.reserve(_maxBatch);
+        return true;
+    }
+
+    /**
+     * @brief Commit anything pending and close the file
+     */
+    void close() {
+        if (_fd >= 0) {
+            commit();
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    void onTransfer(const TransferEvent& e) {
+        append(JournalRecord::Kind::Transfer, e.from, e.to, e.value);
+    }
+
+    void onApproval(const ApprovalEvent& e) {
+        append(JournalRecord::Kind::Approval, e.owner, e.spender, e.value);
+    }
+
+    /**
+     * @brief Write and fdatasync all pending records as one group
+     * @return false if the journal is closed or an I/O error has occurred
+     */
+    bool commit() {
+        if (_fd < 0 || _failed) {
+            return false;
+        }
+        if (_pending.empty()) {
+            return true;
+        }
+        const auto* p = reinterpret_cast<const uint8_t*>(_pending.data());
+        size_t len = _pending.size() * sizeof(JournalRecord);
+        while (len > 0) {
+            ssize_t n = ::write(_fd, p, len);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                _failed = true;
+                return false;
+            }
+            p += n;
+            len -= static_cast<size_t>(n);
+        }
+        if (::fdatasync(_fd) != 0) {
+            _failed = true;
+            return false;
+        }
+        _committed = _pending.back().sequence;
+        _pending.clear();
+        return true;
+    }
+
+    /**
+     * @brief Commit the pending group if its oldest record is older than maxDelay
+     * @return false if the journal is closed or an I/O error has occurred
+     */
+    bool poll() {
+        if (!_pending.empty() && std::chrono::steady_clock::now() - _oldestPending >= _maxDelay) {
+            return commit();
+        }
+        return healthy();
+    }
+
+    /**
+     * @brief Sequence number of the last durable record
+     */
+    uint64_t committedSequence() const {
+        return _committed;
+    }
+
+    /**
+     * @brief Sequence number of the last appended (possibly pending) record
+     */
+    uint64_t lastSequence() const {
+        return _nextSequence - 1;
+    }
+
+    /**
+     * @brief False once a write or sync has failed; later records are dropped
+     */
+    bool healthy() const {
+        return _fd >= 0 && !_failed;
+    }
+
+private:
+    void append(JournalRecord::Kind kind, const Address& a, const Address& b, const uint256_t& value) {
+        if (_fd < 0 || _failed) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (_pending.empty()) {
+            _oldestPending = now;
+        }
+
+        JournalRecord r{};
+        r.kind = kind;
+        r.sequence = _nextSequence++;
+        r.a = a;
+        r.b = b;
+        r.value = value;
+        r.checksum = r.computeChecksum();
+        _pending.push_back(r);
+
+        if (_pending.size() >= _maxBatch || now - _oldestPending >= _maxDelay) {
+            commit();
+        }
+    }
+
+    /**
+     * @brief Length of the intact record prefix and the last sequence in it
+     */
+    static void scanJournal(int fd, uint64_t& validBytes, uint64_t& lastSequence) {
+        JournalRecord r;
+        validBytes = 0;
+        lastSequence = 0;
+        while (::pread(fd, &r, sizeof(r), static_cast<off_t>(validBytes)) == sizeof(r) &&
+               r.checksum == r.computeChecksum() && r.sequence > lastSequence) {
+            lastSequence = r.sequence;
+            validBytes += sizeof(r);
+        }
+    }
+
+    int _fd = -1;
+    size_t _maxBatch = 1024;
+    std::chrono::microseconds _maxDelay{2000};
+    std::chrono::steady_clock::time_point _oldestPending;
+    std::vector<JournalRecord> _pending;
+    uint64_t _nextSequence = 1;
+    uint64_t _committed = 0;
+    bool _failed = false;
+};
+
+/**
+ * @brief Applies journal records to a TokenContract without checks or events
+ */
+class JournalReplay {
+public:
+    template <typename Token>
+    static void apply(Token& token, const JournalRecord& r) {
+        if (r.kind == JournalRecord::Kind::Approval) {
+            token.storeAllowance({r.a, r.b}, token.allowanceEntry({r.a, r.b}), r.value);
+        } else if (r.a != r.b) {
+            token.moveBalance(&token.balanceEntry(r.a), r.a, r.b, r.value);
+        }
+    }
+};
+
+/**
+ * @brief Replay the records after afterSequence onto token
+ *
+ * Use the snapshot's header sequence (or 0 for a contract constructed
+ * fresh with the journal's initial supply). Stops at the first torn or
+ * corrupt record.
+ *
+ * @return Sequence of the last record applied (afterSequence if none)
+ */
+template <typename Token>
+uint64_t replayJournal(const std::string& path, Token& token, uint64_t afterSequence) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return afterSequence;
+    }
+
+    std::vector<JournalRecord> chunk(4096);
+    uint64_t last = afterSequence;
+    uint64_t previous = 0;
+    off_t offset = 0;
+    for (;;) {
+        ssize_t n = ::pread(fd, chunk.data(), chunk.size() * sizeof(JournalRecord), offset);
+        if (n <= 0) {
+            break;
+        }
+        size_t records = static_cast<size_t>(n) / sizeof(JournalRecord);
+        for (size_t i = 0; i < records; i++) {
+            const JournalRecord& r = chunk[i];
+            if (r.checksum != r.computeChecksum() || r.sequence <= previous) {
+                ::close(fd);
+                return last;
+            }
+            previous = r.sequence;
+            if (r.sequence > afterSequence) {
+                JournalReplay::apply(token, r);
+                last = r.sequence;
+            }
+        }
+        if (records == 0) {
+            break;
+        }
+        offset += static_cast<off_t>(records * sizeof(JournalRecord));
+    }
+    ::close(fd);
+    return last;
+}
@@ -0,0 +1,457 @@
+/**
+ * @file
+ * @brief Memory-mapped binary snapshot of token state
+ *
+ * Demonstrates:
+ * - Versioned, checksummed file layout: header + sorted fixed-width records
+ * - Atomic publish (write temp file, fsync, rename)
+ * - Zero-copy reads straight from a read-only mapping
+ *
+ * Layout (little-endian, 8-byte aligned):
+ *
+ *   SnapshotHeader
+ *   BalanceRecord[balanceCount]       sorted by owner
+ *   AllowanceRecord[allowanceCount]   sorted by (owner, spender)
+ *   zero padding to 64 bytes
+ *   balance filter, allowance filter  blocked Bloom filters over the record keys
+ *
+ * The writer builds the filters from the records it writes. Lookups
+ * probe them in place before binary searching, so a key the snapshot
+ * lacks (typically an account that never held the token) usually costs
+ * one cache line instead of a probe per halving. Filter keys come from
+ * their own frozen hash, named by SnapshotHeader::filterHash, never from
+ * the in-memory table hash. Files without filters, or with an unknown
+ * filter hash, are searched directly.
+ *
+ * A contract opened from a snapshot serves untouched accounts from the
+ * mapping and copies a record into its hash tables on first write, so
+ * cold start costs roughly the page faults of the records actually used.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "address.hpp"
+#include "bloom_filter.hpp"
+#include "uint256.hpp"
+
+static_assert(std::endian::native == std::endian::little, "snapshot records are stored in host byte order");
+
+/**
+ * @brief XXH64-style word-at-a-time checksum (not bit-compatible with xxHash)
+ */
+inline uint64_t snapshotChecksum(const void* data, size_t len) {
+    constexpr uint64_t p1 = 0x9e3779b185ebca87ull;
+    constexpr uint64_t p2 = 0xc2b2ae3d27d4eb4full;
+    auto round = [&](uint64_t acc, uint64_t w) { return std::rotl(acc + w * p2, 31) * p1; };
+
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t lanes[4] = {p1 + p2, p2, 0, 0 - p1};
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        for (int l = 0; l < 4; l++) {
+            uint64_t w;
+            std::memcpy(&w, p + i + l * 8, 8);
+            lanes[l] = round(lanes[l], w);
+        }
+    }
+    uint64_t h = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    h += len;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = std::rotl(h ^ round(0, w), 27) * p1 + p2;
+    }
+    for (; i < len; i++) {
+        h = std::rotl(h ^ (p[i] * p1), 11) * p2;
+    }
+    h ^= h >> 33;
+    h *= p2;
+    h ^= h >> 29;
+    return h ^ (h >> 32);
+}
+
+namespace detail {
+
+/**
+ * @brief splitmix64 finalizer
+ */
+inline uint64_t filterMix(uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+/**
+ * @brief All 20 address bytes folded into seed
+ */
+inline uint64_t filterAddressHash(const Address& a, uint64_t seed) {
+    uint64_t w0;
+    uint64_t w1;
+    uint32_t w2;
+    std::memcpy(&w0, a.bytes, 8);
+    std::memcpy(&w1, a.bytes + 8, 8);
+    std::memcpy(&w2, a.bytes + 16, 4);
+    uint64_t h = filterMix(seed ^ w0);
+    h = filterMix(h ^ w1);
+    return filterMix(h ^ w2);
+}
+
+} // namespace detail
+
+/**
+ * @brief Filter key of a balance record (filter hash 1)
+ *
+ * Stored filters depend on it: any change needs a new
+ * SnapshotHeader::kFilterHash id. Deliberately not AddressHash, so the
+ * hash tables can be retuned without touching files on disk.
+ */
+inline uint64_t balanceFilterKey(const Address& owner) {
+    return detail::filterAddressHash(owner, 0x243f6a8885a308d3ull);
+}
+
+/**
+ * @brief Filter key of an allowance record (filter hash 1, same rule)
+ */
+inline uint64_t allowanceFilterKey(const Address& owner, const Address& spender) {
+    return detail::filterAddressHash(spender, detail::filterAddressHash(owner, 0x13198a2e03707344ull));
+}
+
+/**
+ * @brief Fixed 256-byte file header
+ */
+struct SnapshotHeader {
+    static constexpr char kMagic[8] = {'E', 'R', 'C', '2', '0', 'S', 'N', 'P'};
+    static constexpr uint32_t kVersion = 1;
+    // Id of balanceFilterKey / allowanceFilterKey; 0 in files written before it was recorded
+    static constexpr uint8_t kFilterHash = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t balanceCount;
+    uint64_t allowanceCount;
+    uint64_t balancesOffset;
+    uint64_t allowancesOffset;
+    uint64_t balancesChecksum;
+    uint64_t allowancesChecksum;
+    // Position of the last operation included (e.g. a journal sequence)
+    uint64_t sequence;
+    uint256_t totalSupply;
+    uint8_t decimals;
+    // Key function the filters were built with; filters under any other id are ignored
+    uint8_t filterHash;
+    uint8_t reserved[6];
+    char name[64];
+    char symbol[32];
+    // Filter locations, zero when absent; filtersChecksum covers both
+    uint64_t balanceFilterOffset;
+    uint64_t balanceFilterBlocks;
+    uint64_t allowanceFilterOffset;
+    uint64_t allowanceFilterBlocks;
+    uint64_t filtersChecksum;
+    // Covers every byte above
+    uint64_t headerChecksum;
+};
+
+static_assert(sizeof(SnapshotHeader) == 256);
+
+/**
+ * @brief One holder, 56 bytes
+ */
+struct BalanceRecord {
+    Address owner;
+    uint32_t reserved;
+    uint256_t value;
+};
+
+static_assert(sizeof(BalanceRecord) == 56 && offsetof(BalanceRecord, value) == 24);
+
+/**
+ * @brief One (owner, spender) allowance, 72 bytes
+ */
+struct AllowanceRecord {
+    Address owner;
+    Address spender;
+    uint256_t value;
+};
+
+static_assert(sizeof(AllowanceRecord) == 72 && offsetof(AllowanceRecord, value) == 40);
+
+/**
+ * @brief Read-only view of a snapshot file mapped into memory
+ */
+class MappedSnapshot {
+public:
+    /**
+     * @brief Map and validate a snapshot
+     *
+     * The header is always checked. Record checksums are only verified
+     * when requested, because that reads every page and defeats the
+     * point of mapping.
+     *
+     * @return nullptr if the file is missing, truncated or corrupt
+     */
+    static std::unique_ptr<MappedSnapshot> open(const std::string& path, bool verifyRecords = false) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return nullptr;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            return nullptr;
+        }
+
+        std::unique_ptr<MappedSnapshot> snapshot(new MappedSnapshot(base, size));
+        if (!snapshot->validate(verifyRecords)) {
+            return nullptr;
+        }
+        ::madvise(base, size, MADV_RANDOM);
+        return snapshot;
+    }
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    ~MappedSnapshot() {
+        ::munmap(_base, _size);
+    }
+
+    const SnapshotHeader& header() const {
+        return *static_cast<const SnapshotHeader*>(_base);
+    }
+
+    std::span<const BalanceRecord> balances() const {
+        return {at<BalanceRecord>(header().balancesOffset), header().balanceCount};
+    }
+
+    std::span<const AllowanceRecord> allowances() const {
+        return {at<AllowanceRecord>(header().allowancesOffset), header().allowanceCount};
+    }
+
+    /**
+     * @brief Balance record value for owner, or nullptr
+     */
+    const uint256_t* findBalance(const Address& owner) const {
+        if (!BlockedBloomFilter::mayContain(balanceFilter(), balanceFilterKey(owner))) {
+            return nullptr;
+        }
+        auto records = balances();
+        auto it = std::lower_bound(records.begin(), records.end(), owner,
+                                   [](const BalanceRecord& r, const Address& a) { return r.owner < a; });
+        return it != records.end() && it->owner == owner ? &it->value : nullptr;
+    }
+
+    /**
+     * @brief Allowance record value for (owner, spender), or nullptr
+     */
+    const uint256_t* findAllowance(const Address& owner, const Address& spender) const {
+        if (!BlockedBloomFilter::mayContain(allowanceFilter(), allowanceFilterKey(owner, spender))) {
+            return nullptr;
+        }
+        auto records = allowances();
+        auto it = std::lower_bound(records.begin(), records.end(), std::make_pair(owner, spender),
+                                   [](const AllowanceRecord& r, const std::pair<Address, Address>& k) {
+                                       return std::tie(r.owner, r.spender) < std::tie(k.first, k.second);
+                                   });
+        return it != records.end() && it->owner == owner && it->spender == spender ? &it->value : nullptr;
+    }
+
+private:
+    MappedSnapshot(void* base, size_t size) : _base(base), _size(size) {}
+
+    template <typename T>
+    const T* at(uint64_t offset) const {
+        return reinterpret_cast<const T*>(static_cast<const uint8_t*>(_base) + offset);
+    }
+
+    /**
+     * @brief Stored filter words, empty when the file has none built with our filter keys
+     */
+    std::span<const uint64_t> balanceFilter() const {
+        if (header().filterHash != SnapshotHeader::kFilterHash) {
+            return {};
+        }
+        return {at<uint64_t>(header().balanceFilterOffset),
+                header().balanceFilterBlocks * BlockedBloomFilter::kWordsPerBlock};
+    }
+
+    std::span<const uint64_t> allowanceFilter() const {
+        if (header().filterHash != SnapshotHeader::kFilterHash) {
+            return {};
+        }
+        return {at<uint64_t>(header().allowanceFilterOffset),
+                header().allowanceFilterBlocks * BlockedBloomFilter::kWordsPerBlock};
+    }
+
+    bool validate(bool verifyRecords) const {
+        const SnapshotHeader& h = header();
+        if (std::memcmp(h.magic, SnapshotHeader::kMagic, sizeof(h.magic)) != 0 ||
+            h.version != SnapshotHeader::kVersion || h.headerSize != sizeof(SnapshotHeader) ||
+            h.headerChecksum != snapshotChecksum(&h, offsetof(SnapshotHeader, headerChecksum))) {
+            return false;
+        }
+        // Counts are bounded by the file before multiplying (the checksums are no defence against a crafted header)
+        if (h.balancesOffset != sizeof(SnapshotHeader) ||
+            h.balanceCount > (_size - h.balancesOffset) / sizeof(BalanceRecord)) {
+            return false;
+        }
+        uint64_t balancesBytes = h.balanceCount * sizeof(BalanceRecord);
+        if (h.allowancesOffset != h.balancesOffset + balancesBytes ||
+            h.allowanceCount > (_size - h.allowancesOffset) / sizeof(AllowanceRecord)) {
+            return false;
+        }
+        uint64_t allowancesBytes = h.allowanceCount * sizeof(AllowanceRecord);
+        // Both filters or neither, back to back on 64-byte boundaries
+        constexpr uint64_t kBlockBytes = BlockedBloomFilter::kBlockBytes;
+        if ((h.balanceFilterBlocks == 0) != (h.allowanceFilterBlocks == 0)) {
+            return false;
+        }
+        if (h.balanceFilterBlocks != 0 &&
+            (h.balanceFilterOffset % kBlockBytes != 0 || h.balanceFilterOffset < h.allowancesOffset + allowancesBytes ||
+             h.balanceFilterOffset > _size || h.balanceFilterBlocks > (_size - h.balanceFilterOffset) / kBlockBytes ||
+             h.allowanceFilterOffset != h.balanceFilterOffset + h.balanceFilterBlocks * kBlockBytes ||
+             h.allowanceFilterBlocks > (_size - h.allowanceFilterOffset) / kBlockBytes)) {
+            return false;
+        }
+        uint64_t filtersBytes = (h.balanceFilterBlocks + h.allowanceFilterBlocks) * kBlockBytes;
+        if (verifyRecords) {
+            return snapshotChecksum(at<uint8_t>(h.balancesOffset), balancesBytes) == h.balancesChecksum &&
+                   snapshotChecksum(at<uint8_t>(h.allowancesOffset), allowancesBytes) == h.allowancesChecksum &&
+                   (filtersBytes == 0 ||
+                    snapshotChecksum(at<uint8_t>(h.balanceFilterOffset), filtersBytes) == h.filtersChecksum);
+        }
+        return true;
+    }
+
+    void* _base;
+    size_t _size;
+};
+
+namespace detail {
+
+inline bool writeAll(int fd, const void* data, size_t len) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Write token state to path atomically
+ *
+ * Records are written to path + ".tmp", fsynced, then renamed over
+ * path. Zero balances and allowances are omitted. Fresh lookup filters
+ * are built from the records written.
+ *
+ * @param sequence Stored in the header for the caller (see SnapshotHeader)
+ * @return false on any I/O error (path is left untouched)
+ */
+template <typename Token>
+bool writeSnapshot(const Token& token, const std::string& path, uint64_t sequence = 0) {
+    std::vector<BalanceRecord> balances;
+    balances.reserve(token.activeHolderCount());
+    token.forEachBalance([&](const Address& owner, const uint256_t& value) {
+        balances.push_back({owner, 0, value});
+    });
+    std::sort(balances.begin(), balances.end(),
+              [](const BalanceRecord& a, const BalanceRecord& b) { return a.owner < b.owner; });
+
+    std::vector<AllowanceRecord> allowances;
+    token.forEachAllowance([&](const Address& owner, const Address& spender, const uint256_t& value) {
+        allowances.push_back({owner, spender, value});
+    });
+    std::sort(allowances.begin(), allowances.end(), [](const AllowanceRecord& a, const AllowanceRecord& b) {
+        return std::tie(a.owner, a.spender) < std::tie(b.owner, b.spender);
+    });
+
+    BlockedBloomFilter balanceFilter(balances.size());
+    for (const BalanceRecord& r : balances) {
+        balanceFilter.insert(balanceFilterKey(r.owner));
+    }
+    BlockedBloomFilter allowanceFilter(allowances.size());
+    for (const AllowanceRecord& r : allowances) {
+        allowanceFilter.insert(allowanceFilterKey(r.owner, r.spender));
+    }
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SnapshotHeader::kMagic, sizeof(h.magic));
+    h.version = SnapshotHeader::kVersion;
+    h.headerSize = sizeof(SnapshotHeader);
+    h.balanceCount = balances.size();
+    h.allowanceCount = allowances.size();
+    h.balancesOffset = sizeof(SnapshotHeader);
+    h.allowancesOffset = h.balancesOffset + balances.size() * sizeof(BalanceRecord);
+    h.balancesChecksum = snapshotChecksum(balances.data(), balances.size() * sizeof(BalanceRecord));
+    h.allowancesChecksum = snapshotChecksum(allowances.data(), allowances.size() * sizeof(AllowanceRecord));
+    uint64_t recordsEnd = h.allowancesOffset + allowances.size() * sizeof(AllowanceRecord);
+    std::vector<uint64_t> filters(balanceFilter.words().begin(), balanceFilter.words().end());
+    filters.insert(filters.end(), allowanceFilter.words().begin(), allowanceFilter.words().end());
+    const uint8_t zeros[BlockedBloomFilter::kBlockBytes] = {};
+    h.balanceFilterOffset = (recordsEnd + sizeof(zeros) - 1) / sizeof(zeros) * sizeof(zeros);
+    h.balanceFilterBlocks = balanceFilter.blockCount();
+    h.allowanceFilterOffset = h.balanceFilterOffset + balanceFilter.words().size_bytes();
+    h.allowanceFilterBlocks = allowanceFilter.blockCount();
+    h.filtersChecksum = snapshotChecksum(filters.data(), filters.size() * sizeof(uint64_t));
+    h.sequence = sequence;
+    h.totalSupply = token.totalSupply();
+    h.decimals = token.decimals();
+    h.filterHash = SnapshotHeader::kFilterHash;
+    std::string name = token.name();
+    std::string symbol = token.symbol();
+    std::memcpy(h.name, name.data(), std::min(name.size(), sizeof(h.name) - 1));
+    std::memcpy(h.symbol, symbol.data(), std::min(symbol.size(), sizeof(h.symbol) - 1));
+    h.headerChecksum = snapshotChecksum(&h, offsetof(SnapshotHeader, headerChecksum));
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = detail::writeAll(fd, &h, sizeof(h)) &&
+              detail::writeAll(fd, balances.data(), balances.size() * sizeof(BalanceRecord)) &&
+              detail::writeAll(fd, allowances.data(), allowances.size() * sizeof(AllowanceRecord)) &&
+              detail::writeAll(fd, zeros, h.balanceFilterOffset - recordsEnd) &&
+              detail::writeAll(fd, filters.data(), filters.size() * sizeof(uint64_t)) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
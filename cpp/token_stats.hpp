@@ -0,0 +1,348 @@
+/**
+ * @file
+ * @brief Compile-time optional operation counters and latency histograms
+ *
+ * Demonstrates:
+ * - Per-thread, single-writer counters (relaxed load + store, no lock prefix)
+ * - Log-linear (HDR-style) latency buckets, 16 per power of two (~6% error)
+ * - Lock-free hot path; a mutex only when a thread records its first sample
+ * - On-demand aggregation with Prometheus text export
+ *
+ * Build with -DERC20_ENABLE_STATS=1 to turn recording on. Otherwise every
+ * recording hook is an empty inline function and the hot path is
+ * unchanged; collectTokenStats() then reports zeros.
+ *
+ * Latencies are taken with the TSC on x86 (steady_clock elsewhere) and
+ * converted to nanoseconds when aggregated.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef ERC20_ENABLE_STATS
+#define ERC20_ENABLE_STATS 0
+#endif
+
+enum class StatOp : uint8_t { Transfer, TransferFrom, Approve };
+enum class FailReason : uint8_t { InsufficientBalance, InsufficientAllowance };
+
+constexpr size_t kStatOpCount = 3;
+constexpr size_t kFailReasonCount = 2;
+
+/**
+ * @brief Bucket layout shared by recording and aggregation
+ *
+ * Values below 16 get their own bucket; above that each power of two is
+ * split into 16 linear sub-buckets, up to 2^40 ticks.
+ */
+struct LatencyBuckets {
+    static constexpr unsigned kSubBits = 4;
+    static constexpr unsigned kMaxPower = 40;
+    static constexpr size_t kCount = (kMaxPower - kSubBits + 2) << kSubBits;
+
+    static constexpr size_t index(uint64_t v) {
+        if (v < (uint64_t{1} << kSubBits)) {
+            return static_cast<size_t>(v);
+        }
+        unsigned power = static_cast<unsigned>(std::bit_width(v)) - 1;
+        if (power > kMaxPower) {
+            return kCount - 1;
+        }
+        unsigned shift = power - kSubBits;
+        return ((power - kSubBits + 1) << kSubBits) + ((v >> shift) & ((1u << kSubBits) - 1));
+    }
+
+    /**
+     * @brief Smallest value that lands in bucket i
+     */
+    static constexpr uint64_t lowerBound(size_t i) {
+        if (i < (size_t{1} << kSubBits)) {
+            return i;
+        }
+        unsigned power = static_cast<unsigned>(i >> kSubBits) + kSubBits - 1;
+        uint64_t sub = i & ((1u << kSubBits) - 1);
+        return ((uint64_t{1} << kSubBits) + sub) << (power - kSubBits);
+    }
+};
+
+static_assert(LatencyBuckets::index(15) == 15 && LatencyBuckets::index(16) == 16 && LatencyBuckets::index(31) == 31);
+static_assert(LatencyBuckets::lowerBound(LatencyBuckets::index(1000)) <= 1000 &&
+              LatencyBuckets::lowerBound(LatencyBuckets::index(1000) + 1) > 1000);
+
+/**
+ * @brief Aggregated view of one operation type
+ */
+struct OpStats {
+    uint64_t count = 0;
+    uint64_t failures[kFailReasonCount] = {};
+    double latencySumNs = 0;
+    // Per-bucket sample counts, see LatencyBuckets
+    std::array<uint64_t, LatencyBuckets::kCount> latency = {};
+    double nsPerTick = 1.0;
+
+    uint64_t failureCount() const {
+        uint64_t n = 0;
+        for (uint64_t f : failures) {
+            n += f;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Latency at quantile q in [0, 1], in nanoseconds (bucket lower bound)
+     */
+    double percentileNs(double q) const {
+        uint64_t samples = 0;
+        for (uint64_t c : latency) {
+            samples += c;
+        }
+        if (samples == 0) {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(q * static_cast<double>(samples - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < latency.size(); i++) {
+            seen += latency[i];
+            if (seen > rank) {
+                return static_cast<double>(LatencyBuckets::lowerBound(i)) * nsPerTick;
+            }
+        }
+        return static_cast<double>(LatencyBuckets::lowerBound(latency.size() - 1)) * nsPerTick;
+    }
+};
+
+/**
+ * @brief Totals over every thread, as returned by collectTokenStats()
+ */
+struct TokenStats {
+    OpStats ops[kStatOpCount];
+
+    const OpStats& operator[](StatOp op) const {
+        return ops[static_cast<size_t>(op)];
+    }
+
+    /**
+     * @brief Prometheus text exposition format
+     *
+     * Histogram buckets end just below power-of-two tick boundaries,
+     * which coincide with internal bucket edges, so counts stay exact.
+     * Each le is the largest whole tick count its bucket holds
+     * (2^power - 1), as Prometheus buckets include their upper edge.
+     */
+    std::string toPrometheus() const {
+        static constexpr const char* kOpNames[kStatOpCount] = {"transfer", "transferFrom", "approve"};
+        static constexpr const char* kReasonNames[kFailReasonCount] = {"insufficient_balance",
+                                                                       "insufficient_allowance"};
+        std::ostringstream out;
+        out << "# HELP erc20_ops_total Token operations attempted.\n# TYPE erc20_ops_total counter\n";
+        for (size_t op = 0; op < kStatOpCount; op++) {
+            out << "erc20_ops_total{op=\"" << kOpNames[op] << "\"} " << ops[op].count << "\n";
+        }
+        out << "# HELP erc20_failures_total Token operations rejected, by reason.\n"
+               "# TYPE erc20_failures_total counter\n";
+        for (size_t op = 0; op < kStatOpCount; op++) {
+            for (size_t r = 0; r < kFailReasonCount; r++) {
+                out << "erc20_failures_total{op=\"" << kOpNames[op] << "\",reason=\"" << kReasonNames[r] << "\"} "
+                    << ops[op].failures[r] << "\n";
+            }
+        }
+        out << "# HELP erc20_op_latency_seconds Token operation latency.\n"
+               "# TYPE erc20_op_latency_seconds histogram\n";
+        for (size_t op = 0; op < kStatOpCount; op++) {
+            const OpStats& s = ops[op];
+            uint64_t cumulative = 0;
+            size_t next = 0;
+            for (unsigned power = LatencyBuckets::kSubBits; power <= LatencyBuckets::kMaxPower; power++) {
+                size_t edge = LatencyBuckets::index(uint64_t{1} << power);
+                for (; next < edge; next++) {
+                    cumulative += s.latency[next];
+                }
+                double le = static_cast<double>((uint64_t{1} << power) - 1) * s.nsPerTick * 1e-9;
+                out << "erc20_op_latency_seconds_bucket{op=\"" << kOpNames[op] << "\",le=\"" << le << "\"} "
+                    << cumulative << "\n";
+            }
+            for (; next < s.latency.size(); next++) {
+                cumulative += s.latency[next];
+            }
+            out << "erc20_op_latency_seconds_bucket{op=\"" << kOpNames[op] << "\",le=\"+Inf\"} " << cumulative
+                << "\n";
+            out << "erc20_op_latency_seconds_sum{op=\"" << kOpNames[op] << "\"} " << s.latencySumNs * 1e-9 << "\n";
+            out << "erc20_op_latency_seconds_count{op=\"" << kOpNames[op] << "\"} " << cumulative << "\n";
+        }
+        return out.str();
+    }
+};
+
+#if ERC20_ENABLE_STATS
+
+namespace detail {
+
+inline uint64_t statTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief One thread's counters; written only by that thread
+ */
+struct alignas(64) ThreadStats {
+    std::atomic<uint64_t> count[kStatOpCount] = {};
+    std::atomic<uint64_t> failures[kStatOpCount][kFailReasonCount] = {};
+    std::atomic<uint64_t> latencySum[kStatOpCount] = {};
+    std::atomic<uint64_t> latency[kStatOpCount][LatencyBuckets::kCount] = {};
+
+    static void bump(std::atomic<uint64_t>& c, uint64_t by = 1) {
+        c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Owns every thread's counters for the life of the process
+ *
+ * Slots outlive their threads so totals never go backwards.
+ */
+class StatsRegistry {
+public:
+    static StatsRegistry& instance() {
+        static StatsRegistry registry;
+        return registry;
+    }
+
+    ThreadStats* attach() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(std::make_unique<ThreadStats>());
+        return _threads.back().get();
+    }
+
+    TokenStats collect() {
+        TokenStats total;
+        double nsPerTick = calibrate();
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t op = 0; op < kStatOpCount; op++) {
+            OpStats& s = total.ops[op];
+            s.nsPerTick = nsPerTick;
+            uint64_t sumTicks = 0;
+            for (const auto& t : _threads) {
+                s.count += t->count[op].load(std::memory_order_relaxed);
+                for (size_t r = 0; r < kFailReasonCount; r++) {
+                    s.failures[r] += t->failures[op][r].load(std::memory_order_relaxed);
+                }
+                sumTicks += t->latencySum[op].load(std::memory_order_relaxed);
+                for (size_t b = 0; b < LatencyBuckets::kCount; b++) {
+                    s.latency[b] += t->latency[op][b].load(std::memory_order_relaxed);
+                }
+            }
+            s.latencySumNs = static_cast<double>(sumTicks) * nsPerTick;
+        }
+        return total;
+    }
+
+private:
+    StatsRegistry() : _startTicks(statTicks()), _startTime(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Nanoseconds per tick, measured over the registry's lifetime so far
+     */
+    double calibrate() const {
+#if defined(__x86_64__) || defined(__i386__)
+        auto elapsed = std::chrono::steady_clock::now() - _startTime;
+        uint64_t ticks = statTicks() - _startTicks;
+        if (ticks == 0) {
+            return 1.0;
+        }
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+               static_cast<double>(ticks);
+#else
+        return static_cast<double>(std::chrono::steady_clock::period::num) * 1e9 /
+               static_cast<double>(std::chrono::steady_clock::period::den);
+#endif
+    }
+
+    std::mutex _mutex;
+    std::vector<std::unique_ptr<ThreadStats>> _threads;
+    uint64_t _startTicks;
+    std::chrono::steady_clock::time_point _startTime;
+};
+
+inline ThreadStats& localStats() {
+    thread_local ThreadStats* mine = StatsRegistry::instance().attach();
+    return *mine;
+}
+
+} // namespace detail
+
+/**
+ * @brief Count one operation and its latency from construction to destruction
+ */
+class ScopedOpTimer {
+public:
+    explicit ScopedOpTimer(StatOp op) : _op(static_cast<size_t>(op)), _start(detail::statTicks()) {}
+
+    ScopedOpTimer(const ScopedOpTimer&) = delete;
+    ScopedOpTimer& operator=(const ScopedOpTimer&) = delete;
+
+    ~ScopedOpTimer() {
+        uint64_t elapsed = detail::statTicks() - _start;
+        detail::ThreadStats& t = detail::localStats();
+        detail::ThreadStats::bump(t.count[_op]);
+        detail::ThreadStats::bump(t.latencySum[_op], elapsed);
+        detail::ThreadStats::bump(t.latency[_op][LatencyBuckets::index(elapsed)]);
+    }
+
+private:
+    size_t _op;
+    uint64_t _start;
+};
+
+/**
+ * @brief Count an operation without timing it (e.g. items of a parallel batch)
+ */
+inline void recordOp(StatOp op) {
+    detail::ThreadStats::bump(detail::localStats().count[static_cast<size_t>(op)]);
+}
+
+inline void recordFailure(StatOp op, FailReason reason) {
+    detail::ThreadStats::bump(detail::localStats().failures[static_cast<size_t>(op)][static_cast<size_t>(reason)]);
+}
+
+/**
+ * @brief Totals over every thread that has recorded anything
+ */
+inline TokenStats collectTokenStats() {
+    return detail::StatsRegistry::instance().collect();
+}
+
+#else
+
+class ScopedOpTimer {
+public:
+    explicit ScopedOpTimer(StatOp) {}
+};
+
+inline void recordOp(StatOp) {}
+
+inline void recordFailure(StatOp, FailReason) {}
+
+inline TokenStats collectTokenStats() {
+    return {};
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Batch transfer records and per-item status bitmap
+ *
+ * Demonstrates:
+ * - Contiguous, trivially copyable transfer records
+ * - One status bit per item instead of one bool return per call
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "address.hpp"
+#include "uint256.hpp"
+
+/**
+ * @brief One replayed transfer or transferFrom call
+ *
+ * `from` is the account debited. For Kind::Transfer it is also the
+ * caller (msg.sender); for Kind::TransferFrom the caller is `spender`.
+ */
+struct TransferOp {
+    enum class Kind : uint8_t { Transfer, TransferFrom };
+
+    Kind kind;
+    Address spender;
+    Address from;
+    Address to;
+    uint256_t amount;
+
+    static TransferOp transfer(const Address& from, const Address& to, const uint256_t& amount) {
+        return {Kind::Transfer, from, from, to, amount};
+    }
+
+    static TransferOp transferFrom(const Address& spender, const Address& from, const Address& to,
+                                   const uint256_t& amount) {
+        return {Kind::TransferFrom, spender, from, to, amount};
+    }
+};
+
+/**
+ * @brief Success bit per batch item
+ */
+class BatchStatus {
+public:
+    BatchStatus() = default;
+
+    explicit BatchStatus(size_t items) : _words((items + 63) / 64, 0), _size(items) {}
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool succeeded(size_t i) const {
+        return (_words[i / 64] >> (i % 64)) & 1;
+    }
+
+    void markSucceeded(size_t i) {
+        _words[i / 64] |= uint64_t{1} << (i % 64);
+    }
+
+    size_t successCount() const {
+        size_t n = 0;
+        for (uint64_t w : _words) {
+            n += static_cast<size_t>(std::popcount(w));
+        }
+        return n;
+    }
+
+    /**
+     * @brief Raw bitmap, item i at bit i % 64 of word i / 64
+     */
+    const std::vector<uint64_t>& words() const {
+        return _words;
+    }
+
+private:
+    std::vector<uint64_t> _words;
+    size_t _size = 0;
+};
@@ -0,0 +1,246 @@
+/**
+ * @file
+ * @brief Fixed-width 256-bit unsigned integer for token amounts
+ *
+ * Demonstrates:
+ * - Four 64-bit limbs, least significant first
+ * - constexpr arithmetic usable in constant expressions
+ * - Carry/borrow chains lowered to adc/sbb at runtime
+ * - Overflow-checked add and subtract
+ */
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#if !defined(__clang__) && (defined(__x86_64__) || defined(_M_X64))
+#include <immintrin.h>
+#endif
+
+namespace detail {
+
+/**
+ * @brief a + b + carryIn, writing the carry out
+ */
+constexpr uint64_t addCarry(uint64_t a, uint64_t b, uint64_t carryIn, uint64_t& carryOut) {
+    if (!std::is_constant_evaluated()) {
+#if defined(__clang__)
+        unsigned long long carry;
+        uint64_t sum = __builtin_addcll(a, b, carryIn, &carry);
+        carryOut = carry;
+        return sum;
+#elif defined(__x86_64__) || defined(_M_X64)
+        unsigned long long sum;
+        carryOut = _addcarry_u64(static_cast<unsigned char>(carryIn), a, b, &sum);
+        return sum;
+#endif
+    }
+    uint64_t partial = a + b;
+    uint64_t sum = partial + carryIn;
+    carryOut = (partial < a) | (sum < partial);
+    return sum;
+}
+
+/**
+ * @brief a - b - borrowIn, writing the borrow out
+ */
+constexpr uint64_t subBorrow(uint64_t a, uint64_t b, uint64_t borrowIn, uint64_t& borrowOut) {
+    if (!std::is_constant_evaluated()) {
+#if defined(__clang__)
+        unsigned long long borrow;
+        uint64_t diff = __builtin_subcll(a, b, borrowIn, &borrow);
+        borrowOut = borrow;
+        return diff;
+#elif defined(__x86_64__) || defined(_M_X64)
+        unsigned long long diff;
+        borrowOut = _subborrow_u64(static_cast<unsigned char>(borrowIn), a, b, &diff);
+        return diff;
+#endif
+    }
+    uint64_t partial = a - b;
+    uint64_t diff = partial - borrowIn;
+    borrowOut = (a < b) | (partial < borrowIn);
+    return diff;
+}
+
+} // namespace detail
+
+/**
+ * @brief 256-bit unsigned integer with wrapping operators
+ *
+ * The plain operators wrap modulo 2^256 like Solidity's `unchecked`
+ * blocks; use checkedAdd / checkedSub where overflow must be detected.
+ */
+class uint256_t {
+public:
+    constexpr uint256_t() : _limbs{0, 0, 0, 0} {}
+
+    constexpr uint256_t(uint64_t value) : _limbs{value, 0, 0, 0} {}
+
+    /**
+     * @brief Build from limbs, least significant first
+     */
+    static constexpr uint256_t fromLimbs(uint64_t l0, uint64_t l1, uint64_t l2, uint64_t l3) {
+        uint256_t r;
+        r._limbs[0] = l0;
+        r._limbs[1] = l1;
+        r._limbs[2] = l2;
+        r._limbs[3] = l3;
+        return r;
+    }
+
+    /**
+     * @brief Largest representable value (2^256 - 1)
+     */
+    static constexpr uint256_t max() {
+        return fromLimbs(~0ull, ~0ull, ~0ull, ~0ull);
+    }
+
+    constexpr uint64_t limb(int i) const {
+        return _limbs[i];
+    }
+
+    constexpr bool isZero() const {
+        return (_limbs[0] | _limbs[1] | _limbs[2] | _limbs[3]) == 0;
+    }
+
+    /**
+     * @brief out = a + b
+     * @return false if the sum overflowed 256 bits
+     */
+    friend constexpr bool checkedAdd(const uint256_t& a, const uint256_t& b, uint256_t& out) {
+        uint64_t carry = 0;
+        uint256_t r;
+        r._limbs[0] = detail::addCarry(a._limbs[0], b._limbs[0], 0, carry);
+        r._limbs[1] = detail::addCarry(a._limbs[1], b._limbs[1], carry, carry);
+        r._limbs[2] = detail::addCarry(a._limbs[2], b._limbs[2], carry, carry);
+        r._limbs[3] = detail::addCarry(a._limbs[3], b._limbs[3], carry, carry);
+        out = r;
+        return carry == 0;
+    }
+
+    /**
+     * @brief out = a - b
+     * @return false if b > a (the difference underflowed)
+     */
+    friend constexpr bool checkedSub(const uint256_t& a, const uint256_t& b, uint256_t& out) {
+        uint64_t borrow = 0;
+        uint256_t r;
+        r._limbs[0] = detail::subBorrow(a._limbs[0], b._limbs[0], 0, borrow);
+        r._limbs[1] = detail::subBorrow(a._limbs[1], b._limbs[1], borrow, borrow);
+        r._limbs[2] = detail::subBorrow(a._limbs[2], b._limbs[2], borrow, borrow);
+        r._limbs[3] = detail::subBorrow(a._limbs[3], b._limbs[3], borrow, borrow);
+        out = r;
+        return borrow == 0;
+    }
+
+    friend constexpr uint256_t operator+(const uint256_t& a, const uint256_t& b) {
+        uint256_t r;
+        checkedAdd(a, b, r);
+        return r;
+    }
+
+    friend constexpr uint256_t operator-(const uint256_t& a, const uint256_t& b) {
+        uint256_t r;
+        checkedSub(a, b, r);
+        return r;
+    }
+
+    constexpr uint256_t& operator+=(const uint256_t& o) {
+        checkedAdd(*this, o, *this);
+        return *this;
+    }
+
+    constexpr uint256_t& operator-=(const uint256_t& o) {
+        checkedSub(*this, o, *this);
+        return *this;
+    }
+
+    friend constexpr bool operator==(const uint256_t& a, const uint256_t& b) {
+        return ((a._limbs[0] ^ b._limbs[0]) | (a._limbs[1] ^ b._limbs[1]) |
+                (a._limbs[2] ^ b._limbs[2]) | (a._limbs[3] ^ b._limbs[3])) == 0;
+    }
+
+    /**
+     * @brief a < b, computed as the borrow out of a - b (one sub/sbb chain)
+     */
+    friend constexpr bool operator<(const uint256_t& a, const uint256_t& b) {
+        uint64_t borrow = 0;
+        detail::subBorrow(a._limbs[0], b._limbs[0], 0, borrow);
+        detail::subBorrow(a._limbs[1], b._limbs[1], borrow, borrow);
+        detail::subBorrow(a._limbs[2], b._limbs[2], borrow, borrow);
+        detail::subBorrow(a._limbs[3], b._limbs[3], borrow, borrow);
+        return borrow != 0;
+    }
+
+    friend constexpr bool operator>(const uint256_t& a, const uint256_t& b) {
+        return b < a;
+    }
+
+    friend constexpr bool operator<=(const uint256_t& a, const uint256_t& b) {
+        return !(b < a);
+    }
+
+    friend constexpr bool operator>=(const uint256_t& a, const uint256_t& b) {
+        return !(a < b);
+    }
+
+    friend constexpr std::strong_ordering operator<=>(const uint256_t& a, const uint256_t& b) {
+        if (a == b) {
+            return std::strong_ordering::equal;
+        }
+        return a < b ? std::strong_ordering::less : std::strong_ordering::greater;
+    }
+
+    /**
+     * @brief Divide in place by a 64-bit divisor
+     * @return Remainder
+     */
+    constexpr uint64_t divModSmall(uint64_t divisor) {
+        unsigned __int128 rem = 0;
+        for (int i = 3; i >= 0; i--) {
+            unsigned __int128 cur = (rem << 64) | _limbs[i];
+            _limbs[i] = static_cast<uint64_t>(cur / divisor);
+            rem = cur % divisor;
+        }
+        return static_cast<uint64_t>(rem);
+    }
+
+    /**
+     * @brief Decimal representation
+     */
+    std::string toString() const {
+        if (isZero()) {
+            return "0";
+        }
+        // Peel off 19 decimal digits at a time (10^19 fits in 64 bits)
+        constexpr uint64_t chunk = 10000000000000000000ull;
+        uint256_t v = *this;
+        std::string digits;
+        while (!v.isZero()) {
+            uint64_t part = v.divModSmall(chunk);
+            for (int i = 0; i < 19; i++) {
+                digits.push_back(static_cast<char>('0' + part % 10));
+                part /= 10;
+                if (v.isZero() && part == 0) {
+                    break;
+                }
+            }
+        }
+        return std::string(digits.rbegin(), digits.rend());
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const uint256_t& v) {
+        return os << v.toString();
+    }
+
+private:
+    uint64_t _limbs[4];
+};
+
+static_assert(sizeof(uint256_t) == 32, "uint256_t must be exactly four limbs");
+static_assert(std::is_trivially_copyable_v<uint256_t>);
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief Fixed-size worker pool for data-parallel loops
+ *
+ * Demonstrates:
+ * - Persistent threads parked on a condition variable between jobs
+ * - Dynamic chunked scheduling through one atomic cursor
+ * - The calling thread working alongside the pool
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs parallelFor jobs on a fixed set of threads
+ *
+ * One job at a time; parallelFor is not reentrant.
+ */
+class WorkerPool {
+public:
+    /**
+     * @param threads Total threads including the caller (0 = hardware concurrency)
+     */
+    explicit WorkerPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 1; i < threads; i++) {
+            _threads.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& t : _threads) {
+            t.join();
+        }
+    }
+
+    size_t threadCount() const {
+        return _threads.size() + 1;
+    }
+
+    /**
+     * @brief Call body(begin, end) over [0, count) in chunks, returning when all are done
+     */
+    void parallelFor(size_t count, size_t chunk, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) {
+            return;
+        }
+        if (_threads.empty() || count <= chunk) {
+            body(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _body = &body;
+            _count = count;
+            _chunk = std::max<size_t>(chunk, 1);
+            _cursor.store(0, std::memory_order_relaxed);
+            _active = _threads.size();
+            _generation++;
+        }
+        _wake.notify_all();
+
+        runChunks(body, count, _chunk);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _active == 0; });
+        _body = nullptr;
+    }
+
+private:
+    void runChunks(const std::function<void(size_t, size_t)>& body, size_t count, size_t chunk) {
+        for (;;) {
+            size_t begin = _cursor.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= count) {
+                return;
+            }
+            body(begin, std::min(begin + chunk, count));
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t, size_t)>* body;
+            size_t count, chunk;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [&] { return _stopping || _generation != seen; });
+                if (_stopping) {
+                    return;
+                }
+                seen = _generation;
+                body = _body;
+                count = _count;
+                chunk = _chunk;
+            }
+
+            runChunks(*body, count, chunk);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_active == 0) {
+                _done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(size_t, size_t)>* _body = nullptr;
+    size_t _count = 0;
+    size_t _chunk = 1;
+    std::atomic<size_t> _cursor{0};
+    size_t _active = 0;
+    uint64_t _generation = 0;
+    bool _stopping = false;
+};